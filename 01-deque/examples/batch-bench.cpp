@@ -0,0 +1,75 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "deque.hpp"
+
+struct Record {
+    long id;
+    long timestamp;
+    double value;
+    int source;
+    int flags;
+};
+
+template <typename F>
+static double elapsed_ns(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/* Move `total` records through the deque in batches of `batch`, using
+   either one virtual call per record or one bulk call per batch. Both go
+   through the `Deque<T>` interface, as an ingest loop would. */
+static double per_element(Deque<Record>& d, const std::vector<Record>& in,
+                          std::vector<Record>& out, size_t batch, size_t total) {
+    return elapsed_ns([&] {
+        for (size_t done = 0; done < total; done += batch) {
+            for (size_t i = 0; i < batch; i++)
+                d.push_back(in[i]);
+            for (size_t i = 0; i < batch; i++)
+                out[i] = *d.remove_front();
+        }
+    }) / total;
+}
+
+static double bulk(Deque<Record>& d, const std::vector<Record>& in,
+                   std::vector<Record>& out, size_t batch, size_t total) {
+    return elapsed_ns([&] {
+        for (size_t done = 0; done < total; done += batch) {
+            d.push_back_n(in.data(), batch);
+            d.pop_front_n(out.data(), batch);
+        }
+    }) / total;
+}
+
+int main() {
+    const size_t total = 1 << 24;
+    const size_t batches[] = { 1, 16, 256, 1024, 4096 };
+
+    std::vector<Record> in(4096), out(4096);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = Record{ (long)i, (long)i * 1000, i * 0.5, (int)(i % 7), 0 };
+
+    std::printf("%-8s %14s %14s %14s %14s\n", "batch",
+                "Array 1-by-1", "Array bulk", "List 1-by-1", "List bulk");
+
+    for (size_t batch : batches) {
+        ArrayDeque<Record> a1, a2;
+        ListDeque<Record> l1, l2;
+
+        /* Keep some elements resident so the ring wraps */
+        a1.push_back_n(in.data(), 100);
+        a2.push_back_n(in.data(), 100);
+
+        std::printf("%-8zu %11.2f ns %11.2f ns %11.2f ns %11.2f ns\n", batch,
+                    per_element(a1, in, out, batch, total),
+                    bulk(a2, in, out, batch, total),
+                    per_element(l1, in, out, batch, total / 4),
+                    bulk(l2, in, out, batch, total / 4));
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "deque.hpp"
+
+template <typename F>
+static double elapsed_ns(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/* Replay a backlog burst of `burst` elements, then drain back down to a
+   steady state of `steady` elements, `rounds` times over. */
+static void burst_then_drain(const char* name, DequeCapacityPolicy policy,
+                             size_t burst, size_t steady, size_t rounds) {
+    ArrayDeque<long> ad{policy};
+    size_t peak = 0;
+    double push_ns = 0, pop_ns = 0;
+
+    for (size_t r = 0; r < rounds; r++) {
+        push_ns += elapsed_ns([&] {
+            for (size_t i = 0; i < burst; i++)
+                ad.push_back((long)i);
+        });
+        peak = std::max(peak, ad.capacity());
+
+        pop_ns += elapsed_ns([&] {
+            while (ad.size() > steady)
+                ad.remove_front();
+        });
+    }
+
+    std::printf("%-18s push %5.1f ns/op  drain %5.1f ns/op  peak %9zu  after drain %9zu slots (%zu KiB)\n",
+                name, push_ns / (burst * rounds), pop_ns / ((burst - steady) * rounds),
+                peak, ad.capacity(), ad.capacity() * sizeof(long) / 1024);
+}
+
+static void random_index(size_t n) {
+    ArrayDeque<long> ad;
+    for (size_t i = 0; i < n; i++)
+        ad.push_front((long)i);
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> dis(0, n - 1);
+    std::vector<size_t> idx(n);
+    for (auto& i : idx)
+        i = dis(gen);
+
+    long sum = 0;
+    double ns = elapsed_ns([&] {
+        for (auto i : idx)
+            sum += ad[i];
+    });
+
+    std::printf("%-18s %5.2f ns/op  (checksum %ld)\n", "operator[] random", ns / n, sum);
+}
+
+int main() {
+    const size_t burst = 1 << 22, steady = 1 << 10, rounds = 4;
+
+    burst_then_drain("no shrink", DequeCapacityPolicy{64, 0}, burst, steady, rounds);
+    burst_then_drain("shrink at 1/4", DequeCapacityPolicy{64, 4}, burst, steady, rounds);
+    burst_then_drain("shrink at 1/16", DequeCapacityPolicy{64, 16}, burst, steady, rounds);
+
+    random_index(1 << 16);
+
+    return 0;
+}
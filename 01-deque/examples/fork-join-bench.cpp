@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+#include "thread_pool.hpp"
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/* Recursive fibonacci, forking both halves above a cutoff. */
+static long fib_serial(int n) {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static long fib(ThreadPool& pool, int n) {
+    if (n < 20)
+        return fib_serial(n);
+
+    long a = 0, b = 0;
+    TaskGroup g(pool);
+    g.spawn([&] { a = fib(pool, n - 1); });
+    b = fib(pool, n - 2);
+    g.wait();
+
+    return a + b;
+}
+
+/* A pointer-based binary tree traversed in parallel, forking at every node
+   above a depth cutoff. */
+struct Node {
+    long key;
+    std::unique_ptr<Node> left, right;
+};
+
+static std::unique_ptr<Node> build(long lo, long hi) {
+    if (lo > hi)
+        return nullptr;
+
+    long mid = lo + (hi - lo) / 2;
+    auto n = std::make_unique<Node>();
+    n->key = mid;
+    n->left = build(lo, mid - 1);
+    n->right = build(mid + 1, hi);
+    return n;
+}
+
+static long visit_serial(const Node* n) {
+    if (!n)
+        return 0;
+    // Some work per node, so traversal is not purely memory-bound
+    long h = n->key;
+    for (int i = 0; i < 16; i++)
+        h = h * 6364136223846793005L + 1442695040888963407L;
+    return (h & 1) + visit_serial(n->left.get()) + visit_serial(n->right.get());
+}
+
+static long visit(ThreadPool& pool, const Node* n, int depth) {
+    if (!n || depth >= 12)
+        return visit_serial(n);
+
+    long l = 0, r = 0;
+    TaskGroup g(pool);
+    g.spawn([&] { l = visit(pool, n->left.get(), depth + 1); });
+    r = visit(pool, n->right.get(), depth + 1);
+    g.wait();
+
+    long h = n->key;
+    for (int i = 0; i < 16; i++)
+        h = h * 6364136223846793005L + 1442695040888963407L;
+    return (h & 1) + l + r;
+}
+
+int main() {
+    const int fib_n = 38;
+    auto tree = build(0, (1L << 22) - 1);
+
+    long fs = 0, vs = 0;
+    double fib_base = elapsed_ms([&] { fs = fib_serial(fib_n); });
+    double tree_base = elapsed_ms([&] { vs = visit_serial(tree.get()); });
+
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%u hardware threads\n", hw);
+    std::printf("%-8s %12s %9s %12s %9s\n", "threads", "fib(38) ms", "speedup", "tree ms", "speedup");
+    std::printf("%-8s %12.1f %9s %12.1f %9s\n", "serial", fib_base, "1.00", tree_base, "1.00");
+
+    for (unsigned t = 1; t <= std::max(4u, hw); t *= 2) {
+        ThreadPool pool(t);
+        long f = 0, v = 0;
+
+        double fib_ms = elapsed_ms([&] { pool.run([&] { f = fib(pool, fib_n); }); });
+        double tree_ms = elapsed_ms([&] { pool.run([&] { v = visit(pool, tree.get(), 0); }); });
+
+        if (f != fs || v != vs) {
+            std::printf("result mismatch\n");
+            return 1;
+        }
+
+        std::printf("%-8u %12.1f %9.2f %12.1f %9.2f\n", t,
+                    fib_ms, fib_base / fib_ms, tree_ms, tree_base / tree_ms);
+    }
+
+    return 0;
+}
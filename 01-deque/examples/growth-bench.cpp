@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "deque.hpp"
+
+/* A message-like payload that counts how often it is constructed, copied
+   and moved. The string is long enough to defeat the small string
+   optimization, so every copy costs an allocation. */
+struct Message {
+    static size_t default_ctors, copies, moves;
+
+    std::string body;
+    long id;
+
+    Message() : id(0) { default_ctors++; }
+    Message(std::string b, long i) : body(std::move(b)), id(i) {}
+    Message(const Message& o) : body(o.body), id(o.id) { copies++; }
+    Message(Message&& o) noexcept : body(std::move(o.body)), id(o.id) { moves++; }
+    Message& operator=(const Message& o) { body = o.body; id = o.id; copies++; return *this; }
+    Message& operator=(Message&& o) noexcept { body = std::move(o.body); id = o.id; moves++; return *this; }
+
+    static void reset() { default_ctors = copies = moves = 0; }
+};
+
+size_t Message::default_ctors = 0;
+size_t Message::copies = 0;
+size_t Message::moves = 0;
+
+template <typename F>
+static double ns_per_op(size_t n, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+static void report(const char* name, double ns) {
+    std::printf("%-28s %8.1f ns/op  default=%-8zu copies=%-9zu moves=%zu\n",
+                name, ns, Message::default_ctors, Message::copies, Message::moves);
+}
+
+int main() {
+    const size_t N = 1 << 20;
+    const std::string payload(64, 'm');
+
+    {
+        ArrayDeque<Message> ad;
+        Message::reset();
+        double ns = ns_per_op(N, [&] {
+            for (size_t i = 0; i < N; i++) {
+                Message m{payload, (long)i};
+                ad.push_back(m);
+            }
+        });
+        report("push_back(const T&)", ns);
+    }
+
+    {
+        ArrayDeque<Message> ad;
+        Message::reset();
+        double ns = ns_per_op(N, [&] {
+            for (size_t i = 0; i < N; i++)
+                ad.push_back(Message{payload, (long)i});
+        });
+        report("push_back(T&&)", ns);
+    }
+
+    {
+        ArrayDeque<Message> ad;
+        Message::reset();
+        double ns = ns_per_op(N, [&] {
+            for (size_t i = 0; i < N; i++)
+                ad.emplace_back(payload, (long)i);
+        });
+        report("emplace_back(args...)", ns);
+    }
+
+    {
+        ArrayDeque<long> ad;
+        double ns = ns_per_op(N, [&] {
+            for (size_t i = 0; i < N; i++)
+                ad.push_back((long)i);
+        });
+        std::printf("%-28s %8.1f ns/op\n", "push_back(long) [memcpy]", ns);
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+
+#include "deque.hpp"
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/* Through the abstract interface: one virtual call per element */
+static long sum_virtual(Deque<int>& d) {
+    long s = 0;
+    for (size_t i = 0; i < d.size(); i++)
+        s += d[i];
+    return s;
+}
+
+static long sum_index(ArrayDeque<int>& d) {
+    long s = 0;
+    for (size_t i = 0; i < d.size(); i++)
+        s += d[i];
+    return s;
+}
+
+static long sum_iterator(const ArrayDeque<int>& d) {
+    long s = 0;
+    for (int x : d)
+        s += x;
+    return s;
+}
+
+static long sum_segments(const ArrayDeque<int>& d) {
+    long s = 0;
+    d.for_each_segment([&](ArraySegment<const int> a, ArraySegment<const int> b) {
+        s = std::accumulate(a.begin(), a.end(), s);
+        s = std::accumulate(b.begin(), b.end(), s);
+    });
+    return s;
+}
+
+int main() {
+    const int n = 10000000;
+    const int rounds = 5;
+
+    /* Advance the ring first so the elements wrap around the buffer */
+    ArrayDeque<int> d;
+    d.reserve(1 << 24);
+    for (int i = 0; i < (1 << 23); i++)
+        d.push_back(0);
+    while (!d.empty())
+        d.remove_front();
+    for (int i = 0; i < n; i++)
+        d.push_back(i % 1000);
+
+    std::printf("%-12s %10s %16s\n", "method", "ms", "checksum");
+
+    auto run = [&](const char* name, auto&& sum) {
+        long s = 0;
+        double ms = elapsed_ms([&] {
+            for (int r = 0; r < rounds; r++)
+                s += sum();
+        }) / rounds;
+        std::printf("%-12s %10.2f %16ld\n", name, ms, s / rounds);
+    };
+
+    run("virtual []", [&] { return sum_virtual(d); });
+    run("direct []", [&] { return sum_index(d); });
+    run("iterator", [&] { return sum_iterator(d); });
+    run("segments", [&] { return sum_segments(d); });
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "deque.hpp"
+
+/* Count every trip to the global allocator. */
+static size_t allocations = 0;
+
+void* operator new(size_t n) {
+    allocations++;
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+/* Hold a queue at `resident` elements and time `cycles` push_back +
+   remove_front pairs one by one. */
+template <typename D>
+static void steady_state(const char* name, size_t resident, size_t cycles) {
+    D d;
+    for (size_t i = 0; i < resident; i++)
+        d.push_back((long)i);
+
+    std::vector<double> samples(cycles);
+    long sink = 0;
+
+    size_t before = allocations;
+    for (size_t i = 0; i < cycles; i++) {
+        auto start = std::chrono::steady_clock::now();
+        d.push_back((long)i);
+        sink += *d.remove_front();
+        auto end = std::chrono::steady_clock::now();
+        samples[i] = std::chrono::duration<double, std::nano>(end - start).count();
+    }
+    size_t mallocs = allocations - before;
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) { return samples[(size_t)(p * (cycles - 1))]; };
+
+    std::printf("%-10s mallocs/cycle %5.2f  p50 %6.0f ns  p99 %6.0f ns  p999 %6.0f ns  (%ld)\n",
+                name, (double)mallocs / cycles, pct(0.50), pct(0.99), pct(0.999), sink % 10);
+}
+
+int main() {
+    const size_t cycles = 1 << 20;
+
+    for (size_t resident : { 16, 1024, 65536 }) {
+        std::printf("resident = %zu\n", resident);
+        steady_state<ListDeque<long, HeapNodeAllocator<long>>>("heap", resident, cycles);
+        steady_state<ListDeque<long, ListNodePool<long>>>("pool", resident, cycles);
+    }
+
+    return 0;
+}
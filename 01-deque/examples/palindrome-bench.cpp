@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "deque.hpp"
+#include "palindrome.hpp"
+
+/* A corpus of palindromes (worst case: every byte must be looked at) with
+   a sprinkling of near-misses broken somewhere in the middle. */
+static std::vector<std::string> make_corpus(size_t count, size_t len) {
+    std::mt19937 gen(99);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> corpus;
+
+    for (size_t i = 0; i < count; i++) {
+        std::string half;
+        for (size_t j = 0; j < len / 2; j++)
+            half += (char)letter(gen);
+
+        std::string s = half;
+        s.append(half.rbegin(), half.rend());
+        if (i % 4 == 3)
+            s[s.size() / 2 - 1] ^= 1;
+        corpus.push_back(std::move(s));
+    }
+
+    return corpus;
+}
+
+template <typename F>
+static double elapsed_s(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+template <typename P>
+static void bench_single(const char* name, const std::vector<std::string>& corpus, size_t bytes) {
+    P p;
+    size_t hits = 0;
+    double s = elapsed_s([&] {
+        for (auto& str : corpus)
+            hits += p.is_palindrome(str);
+    });
+    std::printf("  %-26s %9.3f GB/s  (%zu palindromes)\n", name, bytes / s / 1e9, hits);
+}
+
+int main() {
+    std::printf("DirectScan block size: %zu bytes\n", palindrome_detail::block);
+
+    for (size_t len : { 16, 256, 4096, 1 << 16 }) {
+        size_t count = (1 << 24) / len;
+        auto corpus = make_corpus(count, len);
+        size_t bytes = count * len;
+
+        std::printf("%zu strings of %zu bytes\n", count, len);
+        bench_single<Palindrome<ArrayDeque<char>>>("ArrayDeque<char>", corpus, bytes);
+        bench_single<Palindrome<ListDeque<char>>>("ListDeque<char>", corpus, bytes);
+        bench_single<Palindrome<DirectScan>>("DirectScan", corpus, bytes);
+
+        std::vector<std::string_view> views(corpus.begin(), corpus.end());
+        std::unique_ptr<bool[]> results(new bool[views.size()]);
+        Palindrome<DirectScan> p;
+        size_t hits = 0;
+        double s = elapsed_s([&] {
+            hits = p.is_palindrome_n(views.data(), views.size(), results.get());
+        });
+        std::printf("  %-26s %9.3f GB/s  (%zu palindromes)\n", "DirectScan batch", bytes / s / 1e9, hits);
+    }
+
+    return 0;
+}
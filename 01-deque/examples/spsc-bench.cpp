@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "deque.hpp"
+#include "spsc_queue.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static long now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+}
+
+/* Each item carries the time it was produced, so the consumer can sample
+   how long items sit in the queue. */
+struct Item {
+    long seq;
+    long stamp;
+};
+
+struct Result {
+    double mops;
+    std::vector<long> delays;
+};
+
+static void report(const char* name, Result r) {
+    auto& d = r.delays;
+    std::sort(d.begin(), d.end());
+    auto pct = [&](double q) { return d[(size_t)(q * (d.size() - 1))]; };
+
+    std::printf("%-22s %7.1f Mitems/s  queue delay p50 %8ld ns  p99 %9ld ns\n",
+                name, r.mops, pct(0.5), pct(0.99));
+}
+
+/* The baseline: an ArrayDeque guarded by a mutex. */
+static Result mutex_deque(size_t n) {
+    ArrayDeque<Item> dq;
+    std::mutex m;
+    Result r;
+
+    auto start = Clock::now();
+    std::thread producer([&] {
+        for (size_t i = 0; i < n; i++) {
+            std::lock_guard<std::mutex> lock(m);
+            dq.push_back(Item{ (long)i, now_ns() });
+        }
+    });
+
+    for (size_t got = 0; got < n; ) {
+        std::optional<Item> it;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            it = dq.remove_front();
+        }
+        if (!it) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (got++ % 64 == 0)
+            r.delays.push_back(now_ns() - it->stamp);
+    }
+    producer.join();
+
+    r.mops = n / std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    return r;
+}
+
+static Result spsc_single(size_t n) {
+    SPSCQueue<Item> q(1 << 14);
+    Result r;
+
+    auto start = Clock::now();
+    std::thread producer([&] {
+        for (size_t i = 0; i < n; ) {
+            if (q.try_push(Item{ (long)i, now_ns() }))
+                i++;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    for (size_t got = 0; got < n; ) {
+        auto it = q.try_pop();
+        if (!it) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (got++ % 64 == 0)
+            r.delays.push_back(now_ns() - it->stamp);
+    }
+    producer.join();
+
+    r.mops = n / std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    return r;
+}
+
+static Result spsc_batch(size_t n, size_t batch) {
+    SPSCQueue<Item> q(1 << 14);
+    Result r;
+
+    auto start = Clock::now();
+    std::thread producer([&] {
+        std::vector<Item> buf(batch);
+        for (size_t i = 0; i < n; ) {
+            size_t want = std::min(batch, n - i);
+            long stamp = now_ns();
+            for (size_t j = 0; j < want; j++)
+                buf[j] = Item{ (long)(i + j), stamp };
+
+            for (size_t sent = 0; sent < want; ) {
+                size_t k = q.push_n(buf.data() + sent, want - sent);
+                if (k == 0)
+                    std::this_thread::yield();
+                sent += k;
+            }
+            i += want;
+        }
+    });
+
+    std::vector<Item> out(batch);
+    for (size_t got = 0; got < n; ) {
+        size_t k = q.pop_n(out.data(), batch);
+        if (k == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        r.delays.push_back(now_ns() - out[0].stamp);
+        got += k;
+    }
+    producer.join();
+
+    r.mops = n / std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    return r;
+}
+
+int main() {
+    const size_t n = 1 << 23;
+
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    report("mutex + ArrayDeque", mutex_deque(n));
+    report("SPSCQueue 1-by-1", spsc_single(n));
+    report("SPSCQueue batch 64", spsc_batch(n, 64));
+    report("SPSCQueue batch 1024", spsc_batch(n, 1024));
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdio>
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "palindrome.hpp"
+
+/* A seekable stream of `n` bytes that is a palindrome (optionally broken
+   at one position), generated on the fly so the input itself takes no
+   memory. */
+class PalindromeSource : public std::streambuf {
+public:
+    PalindromeSource(uint64_t n, uint64_t broken_at = UINT64_MAX)
+        : n(n), broken_at(broken_at), buf(1 << 16) { fill(0); }
+
+protected:
+    int_type underflow() override {
+        uint64_t next = pos + (egptr() - eback());
+        if (next >= n)
+            return traits_type::eof();
+        fill(next);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+        uint64_t cur = pos + (gptr() - eback());
+        uint64_t target = dir == std::ios_base::beg ? off
+                        : dir == std::ios_base::cur ? cur + off : n + off;
+        return seekpos(target, std::ios_base::in);
+    }
+
+    pos_type seekpos(pos_type p, std::ios_base::openmode) override {
+        if ((uint64_t)p > n)
+            return pos_type(off_type(-1));
+        fill((uint64_t)p);
+        return p;
+    }
+
+private:
+    uint64_t n, broken_at, pos = 0;
+    std::vector<char> buf;
+
+    char at(uint64_t i) const {
+        uint64_t x = std::min(i, n - 1 - i) * 0x9E3779B97F4A7C15ull;
+        x ^= x >> 29;
+        char c = (char)('a' + (x % 26));
+        return i == broken_at ? (char)(c ^ 1) : c;
+    }
+
+    void fill(uint64_t from) {
+        pos = from;
+        size_t len = (size_t)std::min<uint64_t>(buf.size(), n - from);
+        for (size_t i = 0; i < len; i++)
+            buf[i] = at(from + i);
+        setg(buf.data(), buf.data(), buf.data() + len);
+    }
+};
+
+static long max_rss_kib() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+static void run(const char* name, uint64_t n, uint64_t broken_at, bool verify) {
+    PalindromeSource src(n, broken_at);
+    std::istream in(&src);
+
+    auto start = std::chrono::steady_clock::now();
+    bool result = is_palindrome_stream(in, verify);
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%6lu MiB  %-18s %-5s %7.0f MB/s  max RSS %6ld KiB\n",
+                (unsigned long)(n >> 20), name, result ? "yes" : "no", n / s / 1e6, max_rss_kib());
+}
+
+int main() {
+    for (uint64_t mib : { 16, 64, 256, 1024 }) {
+        uint64_t n = mib << 20;
+        run("hash only", n, UINT64_MAX, false);
+        run("hash + verify", n, UINT64_MAX, true);
+        run("broken, verify", n, n / 3, true);
+    }
+
+    return 0;
+}
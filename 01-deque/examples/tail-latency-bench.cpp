@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "deque.hpp"
+
+struct Payload {
+    long fields[4];
+};
+
+/* Time every single push_back while growing the deque to `n` elements. */
+template <typename D>
+static void push_back_latency(const char* name, size_t n) {
+    D d;
+    std::vector<uint32_t> samples(n);
+    Payload p{};
+
+    auto total_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) {
+        p.fields[0] = (long)i;
+        auto start = std::chrono::steady_clock::now();
+        d.push_back(p);
+        auto end = std::chrono::steady_clock::now();
+        samples[i] = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+    auto total_end = std::chrono::steady_clock::now();
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double q) { return samples[(size_t)(q * (n - 1))]; };
+    double total_ms = std::chrono::duration<double, std::milli>(total_end - total_start).count();
+
+    std::printf("%-14s p50 %5u ns  p99 %5u ns  p999 %6u ns  max %10u ns  total %7.1f ms\n",
+                name, pct(0.5), pct(0.99), pct(0.999), samples[n - 1], total_ms);
+}
+
+int main() {
+    for (size_t n : { 1 << 16, 1 << 20, 1 << 23 }) {
+        std::printf("n = %zu\n", n);
+        push_back_latency<ArrayDeque<Payload>>("ArrayDeque", n);
+        push_back_latency<ListDeque<Payload>>("ListDeque", n);
+        push_back_latency<ChunkedDeque<Payload>>("ChunkedDeque", n);
+    }
+
+    return 0;
+}
@@ -5,8 +5,15 @@
 #include <iostream>
 #include <type_traits>
 #include <optional>
+#include <iterator>
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <new>
+#include <cstring>
+#include <utility>
+#include <algorithm>
 #include <cassert>
 
 /* NOTE: Deque, ArrayDeque, ListDeque Declaration modification is not allowed.
@@ -16,132 +23,536 @@ class Deque {
 public:
     virtual ~Deque() = default;
 
-    /* NOTE: We won't implement push functions that take rvalue references. */
     virtual void push_front(const T&) = 0;
     virtual void push_back(const T&) = 0;
+    virtual void push_front(T&&) = 0;
+    virtual void push_back(T&&) = 0;
 
     /* NOTE: Unlike STL implementations which have separate `front` and
        pop_front` functions, we have one unified method for removing an elem. */
     virtual std::optional<T> remove_front() = 0;
     virtual std::optional<T> remove_back() = 0;
 
+    /* Bulk versions of the above. `push_front_n` prepends the range keeping
+       its order, so afterwards (*this)[0] == items[0]. `pop_front_n` and
+       `pop_back_n` move up to `max` elements into `out` in deque order and
+       return how many were moved, so each pop undoes the matching push. */
+    virtual void push_front_n(const T* items, size_t n);
+    virtual void push_back_n(const T* items, size_t n);
+    virtual size_t pop_front_n(T* out, size_t max);
+    virtual size_t pop_back_n(T* out, size_t max);
+
     virtual bool empty() = 0;
     virtual size_t size() = 0;
 
     virtual T& operator[](size_t) = 0;
 };
 
+/* Generic bulk operations, one element at a time. Implementations
+   override these with something better where they can. */
+template <typename T>
+void Deque<T>::push_front_n(const T* items, size_t n) {
+    for (size_t i = n; i > 0; i--)
+        push_front(items[i - 1]);
+}
+
+template <typename T>
+void Deque<T>::push_back_n(const T* items, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        push_back(items[i]);
+}
+
+template <typename T>
+size_t Deque<T>::pop_front_n(T* out, size_t max) {
+    size_t k = std::min(max, size());
+    for (size_t i = 0; i < k; i++)
+        out[i] = std::move(*remove_front());
+    return k;
+}
+
+template <typename T>
+size_t Deque<T>::pop_back_n(T* out, size_t max) {
+    size_t k = std::min(max, size());
+    for (size_t i = k; i > 0; i--)
+        out[i - 1] = std::move(*remove_back());
+    return k;
+}
+
+/* Capacity of an ArrayDeque is always a power of two, so ring indices are
+ * reduced with a mask. When `shrink_divisor` is non-zero, the buffer is
+ * halved once size drops to capacity / shrink_divisor (never below
+ * `min_capacity`, nor below what was last asked for with `reserve()`
+ * until `shrink_to_fit()` is called). A divisor of at least 4 leaves the
+ * halved buffer at most half full, so a shrink can never be followed
+ * directly by a grow. */
+struct DequeCapacityPolicy {
+    size_t min_capacity = 64;
+    size_t shrink_divisor = 4;
+};
+
+/* A contiguous run of ArrayDeque elements. */
+template <typename V>
+struct ArraySegment {
+    V* ptr;
+    size_t len;
+
+    V* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    V* begin() const { return ptr; }
+    V* end() const { return ptr + len; }
+};
+
+/* Random-access iterator over an ArrayDeque. It holds a plain pointer
+ * into the ring and only wraps it when stepping off the end of the
+ * buffer, so dereferencing never computes an index. `V` is `T` or
+ * `const T`. */
+template <typename V>
+class ArrayDequeIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<V>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = V*;
+    using reference = V&;
+
+    ArrayDequeIterator() = default;
+    ArrayDequeIterator(V* cur, V* arr, V* head, size_t mask)
+        : cur(cur), arr(arr), head(head), mask(mask) {}
+
+    /* iterator -> const_iterator */
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, V>>>
+    ArrayDequeIterator(const ArrayDequeIterator<U>& o)
+        : cur(o.cur), arr(o.arr), head(o.head), mask(o.mask) {}
+
+    reference operator*() const { return *cur; }
+    pointer operator->() const { return cur; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    ArrayDequeIterator& operator++() {
+        if ((size_t)(++cur - arr) > mask)
+            cur = arr;
+        return *this;
+    }
+    ArrayDequeIterator& operator--() {
+        if (cur == arr)
+            cur = arr + mask + 1;
+        --cur;
+        return *this;
+    }
+    ArrayDequeIterator operator++(int) { auto t = *this; ++*this; return t; }
+    ArrayDequeIterator operator--(int) { auto t = *this; --*this; return t; }
+
+    ArrayDequeIterator& operator+=(difference_type n) {
+        cur = arr + (((size_t)(cur - arr) + (size_t)n) & mask);
+        return *this;
+    }
+    ArrayDequeIterator& operator-=(difference_type n) { return *this += -n; }
+
+    friend ArrayDequeIterator operator+(ArrayDequeIterator it, difference_type n) { return it += n; }
+    friend ArrayDequeIterator operator+(difference_type n, ArrayDequeIterator it) { return it += n; }
+    friend ArrayDequeIterator operator-(ArrayDequeIterator it, difference_type n) { return it -= n; }
+
+    friend difference_type operator-(const ArrayDequeIterator& a, const ArrayDequeIterator& b) {
+        return (difference_type)a.index() - (difference_type)b.index();
+    }
+
+    friend bool operator==(const ArrayDequeIterator& a, const ArrayDequeIterator& b) { return a.cur == b.cur; }
+    friend bool operator!=(const ArrayDequeIterator& a, const ArrayDequeIterator& b) { return a.cur != b.cur; }
+    friend bool operator<(const ArrayDequeIterator& a, const ArrayDequeIterator& b) { return a.index() < b.index(); }
+    friend bool operator>(const ArrayDequeIterator& a, const ArrayDequeIterator& b) { return b < a; }
+    friend bool operator<=(const ArrayDequeIterator& a, const ArrayDequeIterator& b) { return !(b < a); }
+    friend bool operator>=(const ArrayDequeIterator& a, const ArrayDequeIterator& b) { return !(a < b); }
+
+private:
+    template <typename U>
+    friend class ArrayDequeIterator;
+
+    V* cur = nullptr;
+    V* arr = nullptr;
+    V* head = nullptr;  // first element; positions are measured from here
+    size_t mask = 0;
+
+    /* Logical position in the deque. The ring always keeps a free slot,
+       so end() never aliases begin(). */
+    size_t index() const { return (size_t)(cur - head) & mask; }
+};
+
 template <typename T>
 class ArrayDeque : public Deque<T> {
 public:
+    using iterator = ArrayDequeIterator<T>;
+    using const_iterator = ArrayDequeIterator<const T>;
+
     ArrayDeque();
-    ~ArrayDeque() = default;
+    explicit ArrayDeque(DequeCapacityPolicy);
+    ~ArrayDeque();
+
+    ArrayDeque(const ArrayDeque&) = delete;
+    ArrayDeque& operator=(const ArrayDeque&) = delete;
 
     void push_front(const T&) override;
     void push_back(const T&) override;
+    void push_front(T&&) override;
+    void push_back(T&&) override;
+
+    template <typename... Args>
+    T& emplace_front(Args&&...);
+    template <typename... Args>
+    T& emplace_back(Args&&...);
 
     std::optional<T> remove_front() override;
     std::optional<T> remove_back() override;
 
+    void push_front_n(const T*, size_t) override;
+    void push_back_n(const T*, size_t) override;
+    size_t pop_front_n(T*, size_t) override;
+    size_t pop_back_n(T*, size_t) override;
+
     bool empty() override;
     size_t size() override;
     size_t capacity();
 
+    void reserve(size_t);
+    void shrink_to_fit();
+
     T& operator[](size_t) override;
+    const T& operator[](size_t) const;
+
+    iterator begin() { return make_iterator<T>(arr, head()); }
+    iterator end() { return make_iterator<T>(arr, back); }
+    const_iterator begin() const { return make_iterator<const T>(arr, head()); }
+    const_iterator end() const { return make_iterator<const T>(arr, back); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    /* Call `f(first, second)` with the (at most) two contiguous runs that
+       hold the elements in order; `second` is empty unless the ring wraps. */
+    template <typename F>
+    void for_each_segment(F&& f);
+    template <typename F>
+    void for_each_segment(F&& f) const;
 
 private:
-    std::unique_ptr<T[]> arr;
+    /* `arr` is raw storage: only the slots between `front` and `back`
+       (exclusive) hold live objects, the rest are never constructed. */
+    T* arr;
     size_t front;
     size_t back;
     size_t size_;
     size_t capacity_;
+    size_t reserved = 0;    // floor for maybe_shrink, set by reserve()
+    DequeCapacityPolicy policy;
 
+    size_t mask() const { return capacity_ - 1; }
+    size_t head() const { return (front + 1) & mask(); }
     void resize();
+    void maybe_shrink();
+    void grow_to(size_t n);
+    void reallocate(size_t new_capacity);
+    void copy_in(size_t start, const T* items, size_t n);
+    void move_out(size_t start, T* out, size_t n);
+
+    static size_t round_up_pow2(size_t);
+
+    template <typename V>
+    ArrayDequeIterator<V> make_iterator(V* base, size_t pos) const {
+        return ArrayDequeIterator<V>(base + pos, base, base + head(), mask());
+    }
+
+    static T* allocate(size_t);
+    static void deallocate(T*, size_t);
+    static void relocate(T* first, size_t n, T* dest);
 };
 
 template <typename T>
-ArrayDeque<T>::ArrayDeque() :
-    front{63 /* You can change this */},
-    back{0 /* You can change this */},
-    size_{0}, capacity_{64} {
-    arr = std::make_unique<T[]>(capacity_);
+ArrayDeque<T>::ArrayDeque() : ArrayDeque(DequeCapacityPolicy{}) {}
+
+template <typename T>
+ArrayDeque<T>::ArrayDeque(DequeCapacityPolicy p) : size_{0}, policy{p} {
+    assert(policy.shrink_divisor == 0 || policy.shrink_divisor >= 4);
+
+    policy.min_capacity = round_up_pow2(std::max<size_t>(policy.min_capacity, 2));
+    capacity_ = policy.min_capacity;
+    front = capacity_ - 1;
+    back = 0;
+
+    arr = allocate(capacity_);
+}
+
+template <typename T>
+ArrayDeque<T>::~ArrayDeque() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = 0; i < size_; i++)
+            arr[(front + 1 + i) & mask()].~T();
+    }
+
+    deallocate(arr, capacity_);
 }
 
 template <typename T>
 void ArrayDeque<T>::push_front(const T& item) {
-    // TODO
+    emplace_front(item);
+}
+
+template <typename T>
+void ArrayDeque<T>::push_back(const T& item) {
+    emplace_back(item);
+}
+
+template <typename T>
+void ArrayDeque<T>::push_front(T&& item) {
+    emplace_front(std::move(item));
+}
+
+template <typename T>
+void ArrayDeque<T>::push_back(T&& item) {
+    emplace_back(std::move(item));
+}
+
+template <typename T>
+template <typename... Args>
+T& ArrayDeque<T>::emplace_front(Args&&... args) {
     if (front == back) {
+        /* The arguments may refer to an element of this deque, so build
+           the new value before the old buffer goes away. */
+        T item(std::forward<Args>(args)...);
         resize();
+        ::new (static_cast<void*>(arr + front)) T(std::move(item));
+    } else {
+        ::new (static_cast<void*>(arr + front)) T(std::forward<Args>(args)...);
     }
-    
-    arr[front] = item;
-    front = (front - 1) % capacity_;
+
+    T& ref = arr[front];
+    front = (front - 1) & mask();
     size_++;
+
+    return ref;
 }
 
 template <typename T>
-void ArrayDeque<T>::push_back(const T& item) {
-    // TODO
+template <typename... Args>
+T& ArrayDeque<T>::emplace_back(Args&&... args) {
     if (front == back) {
+        T item(std::forward<Args>(args)...);
         resize();
+        ::new (static_cast<void*>(arr + back)) T(std::move(item));
+    } else {
+        ::new (static_cast<void*>(arr + back)) T(std::forward<Args>(args)...);
     }
 
-    arr[back] = item;
-    back = (back + 1) % capacity_; 
+    T& ref = arr[back];
+    back = (back + 1) & mask();
     size_++;
+
+    return ref;
 }
 
 template <typename T>
 std::optional<T> ArrayDeque<T>::remove_front() {
-    // TODO
     if (empty()) {
         return std::nullopt;
     }
 
-    T val = arr[(front + 1) % capacity_];
-    front = (front + 1) % capacity_;
+    size_t idx = (front + 1) & mask();
+    std::optional<T> val{std::move(arr[idx])};
+    arr[idx].~T();
+
+    front = idx;
     size_--;
+    maybe_shrink();
 
     return val;
 }
 
 template <typename T>
 std::optional<T> ArrayDeque<T>::remove_back() {
-    // TODO
     if (empty()) {
         return std::nullopt;
     }
 
-    T val = arr[(back - 1) % capacity_];
-    back = (back - 1) % capacity_;
+    size_t idx = (back - 1) & mask();
+    std::optional<T> val{std::move(arr[idx])};
+    arr[idx].~T();
+
+    back = idx;
     size_--;
+    maybe_shrink();
 
     return val;
 }
 
 template <typename T>
-void ArrayDeque<T>::resize() {
-    // TODO
-    // Allocate new memory
-    // std::unique_ptr new_arr = std::make_unique<T[]>(capacity_ * 2);
-    T* new_arr = new T[capacity_ * 2];
+void ArrayDeque<T>::push_front_n(const T* items, size_t n) {
+    grow_to(size_ + n);
 
-    // Copy from front to end of arr
-    for (size_t i = front; i < capacity_; i++) {
-        new_arr[capacity_ + i] = arr[i];
-    }
+    size_t start = (front + 1 - n) & mask();
+    copy_in(start, items, n);
+
+    front = (start - 1) & mask();
+    size_ += n;
+}
 
-    // Copy from start of arr to back
-    for (size_t i = 0; i < back; i++) {
-        new_arr[i] = arr[i];
+template <typename T>
+void ArrayDeque<T>::push_back_n(const T* items, size_t n) {
+    grow_to(size_ + n);
+
+    copy_in(back, items, n);
+
+    back = (back + n) & mask();
+    size_ += n;
+}
+
+template <typename T>
+size_t ArrayDeque<T>::pop_front_n(T* out, size_t max) {
+    size_t k = std::min(max, size_);
+    size_t head = (front + 1) & mask();
+
+    move_out(head, out, k);
+
+    front = (front + k) & mask();
+    size_ -= k;
+    maybe_shrink();
+
+    return k;
+}
+
+template <typename T>
+size_t ArrayDeque<T>::pop_back_n(T* out, size_t max) {
+    size_t k = std::min(max, size_);
+    size_t start = (back - k) & mask();
+
+    move_out(start, out, k);
+
+    back = start;
+    size_ -= k;
+    maybe_shrink();
+
+    return k;
+}
+
+/* Copy-construct `n` items into the raw ring slots starting at `start`.
+   The range wraps at most once, so this is at most two contiguous copies. */
+template <typename T>
+void ArrayDeque<T>::copy_in(size_t start, const T* items, size_t n) {
+    size_t first = std::min(n, capacity_ - start);
+
+    std::uninitialized_copy_n(items, first, arr + start);
+    try {
+        std::uninitialized_copy_n(items + first, n - first, arr);
+    } catch (...) {
+        std::destroy_n(arr + start, first);
+        throw;
     }
-    
+}
+
+/* Move `n` live elements starting at ring slot `start` into `out` and
+   leave their slots raw. */
+template <typename T>
+void ArrayDeque<T>::move_out(size_t start, T* out, size_t n) {
+    size_t first = std::min(n, capacity_ - start);
+
+    std::move(arr + start, arr + start + first, out);
+    std::move(arr, arr + (n - first), out + first);
+
+    std::destroy_n(arr + start, first);
+    std::destroy_n(arr, n - first);
+}
+
+template <typename T>
+void ArrayDeque<T>::resize() {
+    reallocate(capacity_ * 2);
+}
+
+template <typename T>
+void ArrayDeque<T>::maybe_shrink() {
+    if (policy.shrink_divisor == 0 || capacity_ <= std::max(policy.min_capacity, reserved))
+        return;
+
+    if (size_ <= capacity_ / policy.shrink_divisor)
+        reallocate(capacity_ / 2);
+}
+
+/* Make room for at least `n` elements without further reallocation.
+   Removals will not shrink the buffer below this until shrink_to_fit(). */
+template <typename T>
+void ArrayDeque<T>::reserve(size_t n) {
+    grow_to(n);
+    reserved = std::max(reserved, capacity_);
+}
+
+template <typename T>
+void ArrayDeque<T>::grow_to(size_t n) {
+    // One slot always stays free to tell a full ring from an empty one
+    if (n + 1 > capacity_)
+        reallocate(round_up_pow2(n + 1));
+}
+
+template <typename T>
+void ArrayDeque<T>::shrink_to_fit() {
+    reserved = 0;
+    size_t fit = std::max(policy.min_capacity, round_up_pow2(size_ + 1));
+    if (fit < capacity_)
+        reallocate(fit);
+}
+
+/* Move every element into a fresh buffer of `new_capacity` slots, laid
+   out from index 0 so that the ring is unwrapped again. */
+template <typename T>
+void ArrayDeque<T>::reallocate(size_t new_capacity) {
+    assert(size_ < new_capacity);
+
+    // Allocate uninitialized memory; nothing is default-constructed
+    T* new_arr = allocate(new_capacity);
+
+    size_t head = (front + 1) & mask();
+    size_t first = std::min(size_, capacity_ - head);
+
+    // Move from front to end of arr, then from start of arr to back
+    relocate(arr + head, first, new_arr);
+    relocate(arr, size_ - first, new_arr + first);
+
+    deallocate(arr, capacity_);
+
     // Update member variables;
-    front += capacity_;
-    capacity_ *= 2;
+    capacity_ = new_capacity;
+    front = capacity_ - 1;
+    back = size_;
+    arr = new_arr;
+}
 
-    // Update arr to new_arr
-    arr.reset(new_arr);
+template <typename T>
+size_t ArrayDeque<T>::round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+template <typename T>
+T* ArrayDeque<T>::allocate(size_t n) {
+    return std::allocator<T>{}.allocate(n);
+}
+
+template <typename T>
+void ArrayDeque<T>::deallocate(T* p, size_t n) {
+    std::allocator<T>{}.deallocate(p, n);
+}
+
+/* Move `n` live objects starting at `first` into raw storage at `dest`,
+   leaving the source slots raw. Trivially copyable types are moved with a
+   single memcpy. */
+template <typename T>
+void ArrayDeque<T>::relocate(T* first, size_t n, T* dest) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (n > 0)
+            std::memcpy(static_cast<void*>(dest), first, n * sizeof(T));
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            ::new (static_cast<void*>(dest + i)) T(std::move_if_noexcept(first[i]));
+            first[i].~T();
+        }
+    }
 }
 
 template <typename T>
@@ -165,10 +576,33 @@ size_t ArrayDeque<T>::capacity() {
 template <typename T>
 T& ArrayDeque<T>::operator[](size_t idx) {
     // TODO
-    size_t internal_idx = (front + 1 + idx) % capacity_;
+    size_t internal_idx = (front + 1 + idx) & mask();
     return arr[internal_idx];
 }
 
+template <typename T>
+const T& ArrayDeque<T>::operator[](size_t idx) const {
+    return arr[(front + 1 + idx) & mask()];
+}
+
+template <typename T>
+template <typename F>
+void ArrayDeque<T>::for_each_segment(F&& f) {
+    size_t h = head();
+    size_t first = std::min(size_, capacity_ - h);
+
+    f(ArraySegment<T>{ arr + h, first }, ArraySegment<T>{ arr, size_ - first });
+}
+
+template <typename T>
+template <typename F>
+void ArrayDeque<T>::for_each_segment(F&& f) const {
+    size_t h = head();
+    size_t first = std::min(size_, capacity_ - h);
+
+    f(ArraySegment<const T>{ arr + h, first }, ArraySegment<const T>{ arr, size_ - first });
+}
+
 template<typename T>
 struct ListNode {
     std::optional<T> value;
@@ -177,11 +611,96 @@ struct ListNode {
 
     ListNode() : value(std::nullopt), prev(this), next(this) {}
     ListNode(const T& t) : value(t), prev(this), next(this) {}
+    ListNode(T&& t) : value(std::move(t)), prev(this), next(this) {}
 
     ListNode(const ListNode&) = delete;
 };
 
+/* Node allocator that takes every node straight from the global heap. */
 template<typename T>
+struct HeapNodeAllocator {
+    template<typename... Args>
+    ListNode<T>* create(Args&&... args) {
+        return new ListNode<T>(std::forward<Args>(args)...);
+    }
+
+    void destroy(ListNode<T>* node) { delete node; }
+};
+
+/* Slab allocator for list nodes. Nodes are carved out of slabs that grow
+ * geometrically up to `max_slab_nodes`, and freed nodes are kept on an
+ * intrusive free list threaded through their own storage. Once the list
+ * has reached its working size, pushes and pops never touch the heap.
+ * Slabs are only returned when the pool itself is destroyed. */
+template<typename T>
+class ListNodePool {
+public:
+    static constexpr size_t first_slab_nodes = 16;
+    static constexpr size_t max_slab_nodes = 1024;
+
+    ListNodePool() = default;
+    ListNodePool(const ListNodePool&) = delete;
+    ListNodePool& operator=(const ListNodePool&) = delete;
+
+    template<typename... Args>
+    ListNode<T>* create(Args&&... args);
+    void destroy(ListNode<T>*);
+
+private:
+    union Slot {
+        Slot* next_free;
+        alignas(ListNode<T>) unsigned char storage[sizeof(ListNode<T>)];
+    };
+
+    Slot* free_list = nullptr;
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    size_t next_slab_nodes = first_slab_nodes;
+
+    void add_slab();
+};
+
+template<typename T>
+template<typename... Args>
+ListNode<T>* ListNodePool<T>::create(Args&&... args) {
+    if (!free_list)
+        add_slab();
+
+    Slot* slot = free_list;
+    free_list = slot->next_free;
+
+    try {
+        return ::new (static_cast<void*>(slot->storage))
+            ListNode<T>(std::forward<Args>(args)...);
+    } catch (...) {
+        slot->next_free = free_list;
+        free_list = slot;
+        throw;
+    }
+}
+
+template<typename T>
+void ListNodePool<T>::destroy(ListNode<T>* node) {
+    node->~ListNode<T>();
+
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->next_free = free_list;
+    free_list = slot;
+}
+
+template<typename T>
+void ListNodePool<T>::add_slab() {
+    size_t n = next_slab_nodes;
+    std::unique_ptr<Slot[]> slab{new Slot[n]};
+
+    for (size_t i = 0; i < n; i++)
+        slab[i].next_free = (i + 1 < n) ? &slab[i + 1] : free_list;
+
+    free_list = &slab[0];
+    slabs.push_back(std::move(slab));
+    next_slab_nodes = std::min(2 * n, max_slab_nodes);
+}
+
+template<typename T, typename Alloc = ListNodePool<T>>
 class ListDeque : public Deque<T> {
 public:
     ListDeque();
@@ -189,10 +708,17 @@ public:
 
     void push_front(const T&) override;
     void push_back(const T&) override;
+    void push_front(T&&) override;
+    void push_back(T&&) override;
 
     std::optional<T> remove_front() override;
     std::optional<T> remove_back() override;
 
+    void push_front_n(const T*, size_t) override;
+    void push_back_n(const T*, size_t) override;
+    size_t pop_front_n(T*, size_t) override;
+    size_t pop_back_n(T*, size_t) override;
+
     bool empty() override;
     size_t size() override;
 
@@ -200,16 +726,43 @@ public:
 
     size_t size_ = 0;
     ListNode<T>* sentinel = nullptr;
+
+private:
+    void link_front(ListNode<T>*);
+    void link_back(ListNode<T>*);
+
+    std::pair<ListNode<T>*, ListNode<T>*> make_chain(const T*, size_t);
+    static void splice(ListNode<T>* pos, ListNode<T>* first, ListNode<T>* last);
+    void drain_chain(ListNode<T>* first, T* out, size_t n);
+
+    Alloc nodes;
 };
 
-template<typename T>
-ListDeque<T>::ListDeque() : sentinel(new ListNode<T>{}), size_(0) {}
+template<typename T, typename Alloc>
+ListDeque<T, Alloc>::ListDeque() : sentinel(new ListNode<T>{}), size_(0) {}
 
-template<typename T>
-void ListDeque<T>::push_front(const T& t) {
-    // TODO
-    ListNode<T>* new_node = new ListNode<T>(t);
-    
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::push_front(const T& t) {
+    link_front(nodes.create(t));
+}
+
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::push_back(const T& t) {
+    link_back(nodes.create(t));
+}
+
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::push_front(T&& t) {
+    link_front(nodes.create(std::move(t)));
+}
+
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::push_back(T&& t) {
+    link_back(nodes.create(std::move(t)));
+}
+
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::link_front(ListNode<T>* new_node) {
     new_node->next = sentinel->next;
     new_node->prev = sentinel;
 
@@ -219,11 +772,8 @@ void ListDeque<T>::push_front(const T& t) {
     size_++;
 }
 
-template<typename T>
-void ListDeque<T>::push_back(const T& t) {
-    // TODO
-    ListNode<T>* new_node = new ListNode<T>(t);
-
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::link_back(ListNode<T>* new_node) {
     new_node->prev = sentinel->prev;
     new_node->next = sentinel;
 
@@ -233,56 +783,159 @@ void ListDeque<T>::push_back(const T& t) {
     size_++;
 }
 
-template<typename T>
-std::optional<T> ListDeque<T>::remove_front() {
+template<typename T, typename Alloc>
+std::optional<T> ListDeque<T, Alloc>::remove_front() {
     // TODO
     if (empty()) return std::nullopt;
 
     auto to_delete = sentinel->next;
-    std::optional<T> val = sentinel->next->value;
+    std::optional<T> val = std::move(to_delete->value);
 
     sentinel->next = to_delete->next;
-    sentinel->next->next->prev = sentinel;
+    sentinel->next->prev = sentinel;
 
     size_--;
     
-    delete to_delete;
+    nodes.destroy(to_delete);
 
     return val;
 }
 
-template<typename T>
-std::optional<T> ListDeque<T>::remove_back() {
+template<typename T, typename Alloc>
+std::optional<T> ListDeque<T, Alloc>::remove_back() {
     // TODO
     if (empty()) return std::nullopt;
 
     auto to_delete = sentinel->prev;
-    std::optional<T> val = sentinel->prev->value;
+    std::optional<T> val = std::move(to_delete->value);
 
     sentinel->prev->prev->next = sentinel;
     sentinel->prev = to_delete->prev;
 
     size_--;
 
-    delete to_delete;
+    nodes.destroy(to_delete);
 
     return val;
 }
 
-template<typename T>
-bool ListDeque<T>::empty() {
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::push_front_n(const T* items, size_t n) {
+    if (n == 0) return;
+
+    auto [first, last] = make_chain(items, n);
+    splice(sentinel->next, first, last);
+    size_ += n;
+}
+
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::push_back_n(const T* items, size_t n) {
+    if (n == 0) return;
+
+    auto [first, last] = make_chain(items, n);
+    splice(sentinel, first, last);
+    size_ += n;
+}
+
+template<typename T, typename Alloc>
+size_t ListDeque<T, Alloc>::pop_front_n(T* out, size_t max) {
+    size_t k = std::min(max, size_);
+    if (k == 0) return 0;
+
+    // Cut the first k nodes out as one chain
+    ListNode<T>* first = sentinel->next;
+    ListNode<T>* last = first;
+    for (size_t i = 1; i < k; i++)
+        last = last->next;
+
+    sentinel->next = last->next;
+    last->next->prev = sentinel;
+    size_ -= k;
+
+    drain_chain(first, out, k);
+    return k;
+}
+
+template<typename T, typename Alloc>
+size_t ListDeque<T, Alloc>::pop_back_n(T* out, size_t max) {
+    size_t k = std::min(max, size_);
+    if (k == 0) return 0;
+
+    ListNode<T>* last = sentinel->prev;
+    ListNode<T>* first = last;
+    for (size_t i = 1; i < k; i++)
+        first = first->prev;
+
+    sentinel->prev = first->prev;
+    first->prev->next = sentinel;
+    size_ -= k;
+
+    drain_chain(first, out, k);
+    return k;
+}
+
+/* Build a detached, doubly linked chain holding copies of `items`. */
+template<typename T, typename Alloc>
+std::pair<ListNode<T>*, ListNode<T>*>
+ListDeque<T, Alloc>::make_chain(const T* items, size_t n) {
+    ListNode<T>* first = nodes.create(items[0]);
+    ListNode<T>* last = first;
+
+    try {
+        for (size_t i = 1; i < n; i++) {
+            ListNode<T>* node = nodes.create(items[i]);
+            node->prev = last;
+            last->next = node;
+            last = node;
+        }
+    } catch (...) {
+        while (first != last) {
+            ListNode<T>* temp = first->next;
+            nodes.destroy(first);
+            first = temp;
+        }
+        nodes.destroy(last);
+        throw;
+    }
+
+    return {first, last};
+}
+
+/* Link the chain [first, last] in right before `pos`. */
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::splice(ListNode<T>* pos, ListNode<T>* first, ListNode<T>* last) {
+    first->prev = pos->prev;
+    last->next = pos;
+
+    pos->prev->next = first;
+    pos->prev = last;
+}
+
+/* Move the values of a detached chain of `n` nodes into `out` and free it. */
+template<typename T, typename Alloc>
+void ListDeque<T, Alloc>::drain_chain(ListNode<T>* first, T* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ListNode<T>* temp = first->next;
+        out[i] = std::move(*first->value);
+        nodes.destroy(first);
+        first = temp;
+    }
+}
+
+template<typename T, typename Alloc>
+bool ListDeque<T, Alloc>::empty() {
     // TODO
     return size_ == 0;
 }
 
-template<typename T>
-size_t ListDeque<T>::size() {
+template<typename T, typename Alloc>
+size_t ListDeque<T, Alloc>::size() {
     // TODO
     return size_;
 }
 
-template<typename T>
-T& ListDeque<T>::operator[](size_t idx) {
+template<typename T, typename Alloc>
+T& ListDeque<T, Alloc>::operator[](size_t idx) {
     // TODO
     ListNode<T>* np = sentinel->next;
     size_t count = 0;
@@ -303,8 +956,8 @@ std::ostream& operator<<(std::ostream& os, const ListNode<T>& n) {
     return os;
 }
 
-template<typename T>
-std::ostream& operator<<(std::ostream& os, const ListDeque<T>& l) {
+template<typename T, typename Alloc>
+std::ostream& operator<<(std::ostream& os, const ListDeque<T, Alloc>& l) {
     auto np = l.sentinel->next;
     while (np != l.sentinel) {
         os << *np << ' ';
@@ -314,18 +967,224 @@ std::ostream& operator<<(std::ostream& os, const ListDeque<T>& l) {
     return os;
 }
 
-template<typename T>
-ListDeque<T>::~ListDeque() {
+template<typename T, typename Alloc>
+ListDeque<T, Alloc>::~ListDeque() {
     // TODO
     ListNode<T>* np = sentinel->next;
     
     while (np != sentinel) {
         ListNode<T>* temp = np->next;
-        delete np;
+        nodes.destroy(np);
         np = temp;
     }
 
     delete sentinel;
 }
 
+/* Elements per block of a ChunkedDeque: roughly 4 KiB worth, rounded down
+   to a power of two, but never fewer than 16. */
+template<typename T>
+constexpr size_t chunked_deque_block_size() {
+    size_t n = 16;
+    while (n * 2 * sizeof(T) <= 4096)
+        n *= 2;
+    return n;
+}
+
+/* A deque made of fixed-size blocks plus a map of block pointers. Growing
+ * only ever allocates one new block and appends its pointer to the map, so
+ * elements are never relocated: their addresses stay valid until they are
+ * removed. Random access is one division into the map and one into the
+ * block. One emptied block is kept as a spare so that a queue cycling
+ * across a block boundary does not hit the allocator every time. */
+template<typename T, size_t BlockSize = chunked_deque_block_size<T>()>
+class ChunkedDeque : public Deque<T> {
+    static_assert((BlockSize & (BlockSize - 1)) == 0, "BlockSize must be a power of two");
+
+public:
+    ChunkedDeque() = default;
+    ~ChunkedDeque();
+
+    ChunkedDeque(const ChunkedDeque&) = delete;
+    ChunkedDeque& operator=(const ChunkedDeque&) = delete;
+
+    void push_front(const T&) override;
+    void push_back(const T&) override;
+    void push_front(T&&) override;
+    void push_back(T&&) override;
+
+    template<typename... Args>
+    T& emplace_front(Args&&...);
+    template<typename... Args>
+    T& emplace_back(Args&&...);
+
+    std::optional<T> remove_front() override;
+    std::optional<T> remove_back() override;
+
+    bool empty() override;
+    size_t size() override;
+
+    T& operator[](size_t) override;
+
+private:
+    ArrayDeque<T*> blocks;
+    size_t head = 0;    // offset of the first element within blocks[0]
+    size_t size_ = 0;
+    T* spare = nullptr;
+
+    T* slot(size_t pos) { return blocks[pos / BlockSize] + pos % BlockSize; }
+    T* new_block();
+    void release_block(T*);
+};
+
+template<typename T, size_t BlockSize>
+ChunkedDeque<T, BlockSize>::~ChunkedDeque() {
+    for (size_t i = 0; i < size_; i++)
+        slot(head + i)->~T();
+
+    while (!blocks.empty())
+        std::allocator<T>{}.deallocate(*blocks.remove_back(), BlockSize);
+
+    if (spare)
+        std::allocator<T>{}.deallocate(spare, BlockSize);
+}
+
+template<typename T, size_t BlockSize>
+void ChunkedDeque<T, BlockSize>::push_front(const T& item) {
+    emplace_front(item);
+}
+
+template<typename T, size_t BlockSize>
+void ChunkedDeque<T, BlockSize>::push_back(const T& item) {
+    emplace_back(item);
+}
+
+template<typename T, size_t BlockSize>
+void ChunkedDeque<T, BlockSize>::push_front(T&& item) {
+    emplace_front(std::move(item));
+}
+
+template<typename T, size_t BlockSize>
+void ChunkedDeque<T, BlockSize>::push_back(T&& item) {
+    emplace_back(std::move(item));
+}
+
+template<typename T, size_t BlockSize>
+template<typename... Args>
+T& ChunkedDeque<T, BlockSize>::emplace_front(Args&&... args) {
+    if (head == 0) {
+        blocks.push_front(new_block());
+        head = BlockSize;
+    }
+
+    T* p;
+    try {
+        p = ::new (static_cast<void*>(blocks[0] + head - 1)) T(std::forward<Args>(args)...);
+    } catch (...) {
+        if (head == BlockSize) {
+            release_block(*blocks.remove_front());
+            head = 0;
+        }
+        throw;
+    }
+
+    head--;
+    size_++;
+
+    return *p;
+}
+
+template<typename T, size_t BlockSize>
+template<typename... Args>
+T& ChunkedDeque<T, BlockSize>::emplace_back(Args&&... args) {
+    size_t pos = head + size_;
+
+    if (pos == blocks.size() * BlockSize)
+        blocks.push_back(new_block());
+
+    T* p;
+    try {
+        p = ::new (static_cast<void*>(slot(pos))) T(std::forward<Args>(args)...);
+    } catch (...) {
+        if (pos % BlockSize == 0)
+            release_block(*blocks.remove_back());
+        throw;
+    }
+
+    size_++;
+
+    return *p;
+}
+
+template<typename T, size_t BlockSize>
+std::optional<T> ChunkedDeque<T, BlockSize>::remove_front() {
+    if (empty()) return std::nullopt;
+
+    T* p = blocks[0] + head;
+    std::optional<T> val{std::move(*p)};
+    p->~T();
+
+    head++;
+    size_--;
+
+    if (head == BlockSize) {
+        release_block(*blocks.remove_front());
+        head = 0;
+    }
+
+    return val;
+}
+
+template<typename T, size_t BlockSize>
+std::optional<T> ChunkedDeque<T, BlockSize>::remove_back() {
+    if (empty()) return std::nullopt;
+
+    size_t pos = head + size_ - 1;
+    T* p = slot(pos);
+    std::optional<T> val{std::move(*p)};
+    p->~T();
+
+    size_--;
+
+    // The last block became empty
+    if (pos % BlockSize == 0) {
+        release_block(*blocks.remove_back());
+        if (blocks.empty())
+            head = 0;
+    }
+
+    return val;
+}
+
+template<typename T, size_t BlockSize>
+bool ChunkedDeque<T, BlockSize>::empty() {
+    return size_ == 0;
+}
+
+template<typename T, size_t BlockSize>
+size_t ChunkedDeque<T, BlockSize>::size() {
+    return size_;
+}
+
+template<typename T, size_t BlockSize>
+T& ChunkedDeque<T, BlockSize>::operator[](size_t idx) {
+    return *slot(head + idx);
+}
+
+template<typename T, size_t BlockSize>
+T* ChunkedDeque<T, BlockSize>::new_block() {
+    if (spare)
+        return std::exchange(spare, nullptr);
+
+    return std::allocator<T>{}.allocate(BlockSize);
+}
+
+template<typename T, size_t BlockSize>
+void ChunkedDeque<T, BlockSize>::release_block(T* block) {
+    if (spare)
+        std::allocator<T>{}.deallocate(spare, BlockSize);
+
+    spare = block;
+}
+
 #endif // _DEQUE_H
@@ -0,0 +1,198 @@
+#ifndef _SPSC_QUEUE_H
+#define _SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+/* Bounded single-producer/single-consumer queue.
+ *
+ * The layout is the ArrayDeque ring: a power-of-two buffer of raw slots
+ * indexed by `front` (consumer) and `back` (producer). Here the indices
+ * are free-running counters reduced with a mask, so all `capacity` slots
+ * are usable and `back - front` is the size. Each index lives on its own
+ * cache line and is written by exactly one thread: the producer publishes
+ * constructed slots with a release store to `back`, the consumer returns
+ * emptied slots with a release store to `front`. Each side also keeps a
+ * private copy of the other side's index and only reloads it when the
+ * copy says the ring is full (or empty), so the shared lines are touched
+ * rarely. Every operation is wait-free.
+ *
+ * Only one thread may call the push functions and only one (other) thread
+ * may call the pop functions. */
+template <typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t capacity);
+    ~SPSCQueue();
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /* Producer side */
+    template <typename... Args>
+    bool try_emplace(Args&&...);
+    bool try_push(const T& t) { return try_emplace(t); }
+    bool try_push(T&& t) { return try_emplace(std::move(t)); }
+    size_t push_n(const T* items, size_t n);
+
+    /* Consumer side */
+    std::optional<T> try_pop();
+    size_t pop_n(T* out, size_t max);
+
+    /* Exact only when called from one of the two sides while the other is
+       idle; otherwise a snapshot. */
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr size_t cache_line = 64;
+
+    /* Read-mostly, shared by both sides */
+    alignas(cache_line) T* arr;
+    size_t capacity_;
+
+    /* Written by the consumer */
+    alignas(cache_line) std::atomic<size_t> front{0};
+    size_t cached_back = 0;
+
+    /* Written by the producer */
+    alignas(cache_line) std::atomic<size_t> back{0};
+    size_t cached_front = 0;
+
+    size_t mask() const { return capacity_ - 1; }
+    size_t free_slots(size_t b);
+    size_t ready_slots(size_t f);
+};
+
+template <typename T>
+SPSCQueue<T>::SPSCQueue(size_t capacity) {
+    capacity_ = 1;
+    while (capacity_ < capacity)
+        capacity_ <<= 1;
+
+    arr = std::allocator<T>{}.allocate(capacity_);
+}
+
+template <typename T>
+SPSCQueue<T>::~SPSCQueue() {
+    size_t f = front.load(std::memory_order_relaxed);
+    size_t b = back.load(std::memory_order_relaxed);
+
+    for (; f != b; f++)
+        arr[f & mask()].~T();
+
+    std::allocator<T>{}.deallocate(arr, capacity_);
+}
+
+/* Number of slots the producer may fill, refreshing its view of `front`
+   only when the cached one says the ring is full. */
+template <typename T>
+size_t SPSCQueue<T>::free_slots(size_t b) {
+    size_t n = capacity_ - (b - cached_front);
+    if (n == 0) {
+        cached_front = front.load(std::memory_order_acquire);
+        n = capacity_ - (b - cached_front);
+    }
+    return n;
+}
+
+template <typename T>
+size_t SPSCQueue<T>::ready_slots(size_t f) {
+    size_t n = cached_back - f;
+    if (n == 0) {
+        cached_back = back.load(std::memory_order_acquire);
+        n = cached_back - f;
+    }
+    return n;
+}
+
+template <typename T>
+template <typename... Args>
+bool SPSCQueue<T>::try_emplace(Args&&... args) {
+    size_t b = back.load(std::memory_order_relaxed);
+    if (free_slots(b) == 0)
+        return false;
+
+    ::new (static_cast<void*>(arr + (b & mask()))) T(std::forward<Args>(args)...);
+    back.store(b + 1, std::memory_order_release);
+
+    return true;
+}
+
+/* Push as many of `items` as fit and publish them all with one store.
+   Returns how many were pushed. */
+template <typename T>
+size_t SPSCQueue<T>::push_n(const T* items, size_t n) {
+    size_t b = back.load(std::memory_order_relaxed);
+    n = std::min(n, free_slots(b));
+    if (n == 0)
+        return 0;
+
+    size_t start = b & mask();
+    size_t first = std::min(n, capacity_ - start);
+
+    std::uninitialized_copy_n(items, first, arr + start);
+    try {
+        std::uninitialized_copy_n(items + first, n - first, arr);
+    } catch (...) {
+        std::destroy_n(arr + start, first);
+        throw;
+    }
+
+    back.store(b + n, std::memory_order_release);
+
+    return n;
+}
+
+template <typename T>
+std::optional<T> SPSCQueue<T>::try_pop() {
+    size_t f = front.load(std::memory_order_relaxed);
+    if (ready_slots(f) == 0)
+        return std::nullopt;
+
+    T* p = arr + (f & mask());
+    std::optional<T> val{std::move(*p)};
+    p->~T();
+
+    front.store(f + 1, std::memory_order_release);
+
+    return val;
+}
+
+/* Move up to `max` published elements into `out` and hand all of their
+   slots back to the producer with one store. */
+template <typename T>
+size_t SPSCQueue<T>::pop_n(T* out, size_t max) {
+    size_t f = front.load(std::memory_order_relaxed);
+    size_t n = std::min(max, ready_slots(f));
+    if (n == 0)
+        return 0;
+
+    size_t start = f & mask();
+    size_t first = std::min(n, capacity_ - start);
+
+    std::move(arr + start, arr + start + first, out);
+    std::move(arr, arr + (n - first), out + first);
+    std::destroy_n(arr + start, first);
+    std::destroy_n(arr, n - first);
+
+    front.store(f + n, std::memory_order_release);
+
+    return n;
+}
+
+template <typename T>
+size_t SPSCQueue<T>::size() const {
+    size_t f = front.load(std::memory_order_acquire);
+    size_t b = back.load(std::memory_order_acquire);
+    return b - f;
+}
+
+#endif // _SPSC_QUEUE_H
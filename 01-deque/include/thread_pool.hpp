@@ -0,0 +1,283 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "deque.hpp"
+#include "work_stealing_deque.hpp"
+
+class TaskGroup;
+
+/* A fork/join thread pool. Every worker owns a WorkStealingDeque of
+ * tasks: tasks spawned on a worker go to the bottom of its own deque, and
+ * idle workers steal from the top of others'. Tasks spawned from outside
+ * the pool go through a mutex-guarded injection queue.
+ *
+ * Waiting is never passive while work remains: TaskGroup::wait() keeps
+ * running (and stealing) tasks until its own children have finished, so
+ * recursive fork/join does not block workers. A thread that finds nothing
+ * to run sleeps on a condition variable until a task is pushed or a
+ * group finishes, rather than spinning while one long task runs
+ * elsewhere. */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t n_threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /* Run `f` on the pool and block until it and everything it spawned
+       has finished. The calling thread helps out meanwhile. */
+    template <typename F>
+    void run(F&& f);
+
+    size_t size() const { return workers.size(); }
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+
+    struct Worker {
+        WorkStealingDeque<Task*> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    ListDeque<Task*> injected;          // guarded by `mutex`
+    std::atomic<size_t> injected_size{0};
+
+    /* `epoch` moves on every push and every finished group. A thread
+       reads it before looking for work and sleeps only while it is
+       unchanged, so nothing published after the read can be missed.
+       `sleepers` lets signal() skip the mutex when nobody sleeps. */
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<size_t> sleepers{0};
+
+    static inline thread_local ThreadPool* current_pool = nullptr;
+    static inline thread_local size_t current_index = 0;
+
+    void worker_loop(size_t index);
+    void submit(Task*);
+    Task* find_task();
+    void execute(Task*);
+    bool idle(uint64_t seen);
+    void signal(bool all);
+};
+
+/* A set of tasks that can be waited on together. */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& p) : pool(p) {}
+    ~TaskGroup() { wait_no_throw(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void spawn(F&& f);
+
+    /* Run pool tasks until every task spawned in this group has finished.
+       Rethrows the first exception thrown by one of them. */
+    void wait();
+
+private:
+    friend class ThreadPool;
+
+    ThreadPool& pool;
+    std::atomic<size_t> pending{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    void wait_no_throw();
+};
+
+inline ThreadPool::ThreadPool(size_t n_threads) {
+    if (n_threads == 0)
+        n_threads = 1;
+
+    for (size_t i = 0; i < n_threads; i++)
+        workers.push_back(std::make_unique<Worker>());
+
+    // Start threads only once every deque exists, since they steal from each other
+    for (size_t i = 0; i < n_threads; i++)
+        workers[i]->thread = std::thread([this, i] { worker_loop(i); });
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& w : workers)
+        w->thread.join();
+}
+
+template <typename F>
+void ThreadPool::run(F&& f) {
+    TaskGroup group(*this);
+    group.spawn(std::forward<F>(f));
+    group.wait();
+}
+
+inline void ThreadPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    while (true) {
+        uint64_t seen = epoch.load();
+
+        if (Task* t = find_task()) {
+            execute(t);
+            continue;
+        }
+
+        if (!idle(seen))
+            return;
+    }
+}
+
+/* Sleep until the epoch moves past `seen`. Returns false once the pool
+   is stopping. Counting ourselves in `sleepers` before re-reading the
+   epoch pairs with signal(), which bumps the epoch before reading
+   `sleepers`: one of the two always sees the other. */
+inline bool ThreadPool::idle(uint64_t seen) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    sleepers.fetch_add(1);
+    wake.wait(lock, [&] { return stopping || epoch.load() != seen; });
+    sleepers.fetch_sub(1);
+
+    return !stopping;
+}
+
+/* Announce new work (wake one sleeper) or a finished group (wake all, as
+   the waiter could be any of them). Taking the mutex once makes sure a
+   sleeper that has checked the epoch is inside wait() before notifying. */
+inline void ThreadPool::signal(bool all) {
+    epoch.fetch_add(1);
+
+    if (sleepers.load() == 0)
+        return;
+
+    { std::lock_guard<std::mutex> lock(mutex); }
+
+    if (all)
+        wake.notify_all();
+    else
+        wake.notify_one();
+}
+
+inline void ThreadPool::submit(Task* t) {
+    t->group->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (current_pool == this) {
+        workers[current_index]->tasks.push(t);
+    } else {
+        std::lock_guard<std::mutex> lock(mutex);
+        injected.push_back(t);
+        injected_size.fetch_add(1, std::memory_order_release);
+    }
+
+    signal(false);
+}
+
+/* Own deque first (newest task, best locality), then the injection queue,
+   then steal the oldest task of a random victim. */
+inline ThreadPool::Task* ThreadPool::find_task() {
+    bool is_worker = current_pool == this;
+
+    if (is_worker) {
+        if (auto t = workers[current_index]->tasks.pop())
+            return *t;
+    }
+
+    if (injected_size.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto t = injected.remove_front()) {
+            injected_size.fetch_sub(1, std::memory_order_relaxed);
+            return *t;
+        }
+    }
+
+    static thread_local std::minstd_rand rng{std::random_device{}()};
+    size_t n = workers.size();
+    size_t start = rng() % n;
+
+    for (size_t i = 0; i < n; i++) {
+        size_t victim = (start + i) % n;
+        if (is_worker && victim == current_index)
+            continue;
+        if (auto t = workers[victim]->tasks.steal())
+            return *t;
+    }
+
+    return nullptr;
+}
+
+inline void ThreadPool::execute(Task* t) {
+    TaskGroup* group = t->group;
+
+    try {
+        t->fn();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(group->error_mutex);
+        if (!group->error)
+            group->error = std::current_exception();
+    }
+
+    delete t;
+
+    if (group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        signal(true);
+}
+
+template <typename F>
+void TaskGroup::spawn(F&& f) {
+    pool.submit(new ThreadPool::Task{ std::function<void()>(std::forward<F>(f)), this });
+}
+
+inline void TaskGroup::wait_no_throw() {
+    while (true) {
+        // Read the epoch first, so a last child finishing after the
+        // check below still wakes us
+        uint64_t seen = pool.epoch.load();
+
+        if (pending.load(std::memory_order_acquire) == 0)
+            return;
+
+        if (ThreadPool::Task* t = pool.find_task())
+            pool.execute(t);
+        else
+            pool.idle(seen);
+    }
+}
+
+inline void TaskGroup::wait() {
+    wait_no_throw();
+
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+#endif // _THREAD_POOL_H
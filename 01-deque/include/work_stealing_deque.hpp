@@ -0,0 +1,171 @@
+#ifndef _WORK_STEALING_DEQUE_H
+#define _WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+/* Chase-Lev work-stealing deque (using the C11 memory orderings from Le,
+ * Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+ * Weak Memory Models", PPoPP 2013).
+ *
+ * The owner thread pushes and pops at the bottom (LIFO); any number of
+ * thieves steal from the top (FIFO). The storage is a growable circular
+ * array indexed like ArrayDeque, but with free-running signed indices.
+ * When the owner grows it, the new array is published with a release
+ * store; thieves may still be reading the old one, so retired arrays are
+ * kept until the deque is destroyed. They add up to less than the live
+ * array.
+ *
+ * Thieves copy a slot before they know whether they won it, so T must be
+ * trivially copyable (typically a pointer to a task). */
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WorkStealingDeque elements must be trivially copyable");
+
+public:
+    explicit WorkStealingDeque(size_t capacity = 64);
+    ~WorkStealingDeque() = default;
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /* Owner only */
+    void push(const T&);
+    std::optional<T> pop();
+
+    /* Any thread. Returns nullopt when the deque is empty or when another
+       thread took the element first. */
+    std::optional<T> steal();
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return array.load(std::memory_order_relaxed)->capacity; }
+
+private:
+    struct Array {
+        size_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(size_t c) : capacity(c), slots(new std::atomic<T>[c]) {}
+
+        /* The paper uses relaxed slot accesses ordered by the fences
+           below. Release/acquire on the slot itself costs nothing extra
+           on x86 and lets ThreadSanitizer, which ignores fences, see that
+           a stolen element was published. */
+        T get(int64_t i) const {
+            return slots[i & (capacity - 1)].load(std::memory_order_acquire);
+        }
+        void put(int64_t i, const T& t) {
+            slots[i & (capacity - 1)].store(t, std::memory_order_release);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    alignas(64) std::atomic<Array*> array;
+
+    /* Owner only: every array ever allocated, the live one last */
+    std::vector<std::unique_ptr<Array>> arrays;
+
+    Array* resize(Array*, int64_t t, int64_t b);
+};
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t capacity) {
+    size_t c = 1;
+    while (c < capacity)
+        c <<= 1;
+
+    arrays.push_back(std::make_unique<Array>(c));
+    array.store(arrays.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+void WorkStealingDeque<T>::push(const T& t) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t tp = top.load(std::memory_order_acquire);
+    Array* a = array.load(std::memory_order_relaxed);
+
+    if (b - tp > (int64_t)a->capacity - 1)
+        a = resize(a, tp, b);
+
+    a->put(b, t);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Array* a = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // Empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    T x = a->get(b);
+    if (t == b) {
+        // Last element: race the thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                               std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        if (!won)
+            return std::nullopt;
+    }
+
+    return x;
+}
+
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return std::nullopt;
+
+    Array* a = array.load(std::memory_order_acquire);
+    T x = a->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+        return std::nullopt;
+
+    return x;
+}
+
+template <typename T>
+size_t WorkStealingDeque<T>::size() const {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_relaxed);
+    return b > t ? (size_t)(b - t) : 0;
+}
+
+/* Double the array, copying the live range [t, b) to the same logical
+   indices, and publish it. */
+template <typename T>
+typename WorkStealingDeque<T>::Array*
+WorkStealingDeque<T>::resize(Array* a, int64_t t, int64_t b) {
+    auto bigger = std::make_unique<Array>(a->capacity * 2);
+    for (int64_t i = t; i < b; i++)
+        bigger->put(i, a->get(i));
+
+    Array* na = bigger.get();
+    arrays.push_back(std::move(bigger));
+    array.store(na, std::memory_order_release);
+
+    return na;
+}
+
+#endif // _WORK_STEALING_DEQUE_H
@@ -1,4 +1,18 @@
+#ifndef _PALINDROME_H
+#define _PALINDROME_H
+
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #include "deque.hpp"
 
@@ -6,6 +20,7 @@ template<typename Deque>
 class Palindrome {
 public:
     bool is_palindrome(const std::string&);
+    size_t is_palindrome_n(const std::string_view* inputs, size_t n, bool* results);
     void reset_deque();
 
 private:
@@ -15,6 +30,9 @@ private:
 template<typename Deque>
 bool Palindrome<Deque>::is_palindrome(const std::string& s1) {
     // TODO
+    // Start from an empty deque, even if the last call returned early
+    reset_deque();
+
     // Store every character in the string in the deque
     for (auto &c : s1) {
         deque.push_back(c);
@@ -31,8 +49,275 @@ bool Palindrome<Deque>::is_palindrome(const std::string& s1) {
     return true;
 }
 
+/* Check `n` strings, storing each answer in `results`. Returns how many of
+   them are palindromes. */
+template<typename Deque>
+size_t Palindrome<Deque>::is_palindrome_n(const std::string_view* inputs, size_t n, bool* results) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++)
+        count += results[i] = is_palindrome(std::string(inputs[i]));
+    return count;
+}
+
 template<typename Deque>
 void Palindrome<Deque>::reset_deque() {
     while (!deque.empty())
         deque.remove_front();
 }
+
+/* Use `Palindrome<DirectScan>` to check strings in place, without a
+ * deque. Two cursors converge from both ends; whole blocks are compared
+ * against the byte-reversed block from the other end: 32 bytes with AVX2,
+ * 16 with SSE2, and 8 (via a byte swap) everywhere else. */
+struct DirectScan {};
+
+namespace palindrome_detail {
+
+#if defined(__AVX2__)
+constexpr size_t block = 32;
+
+/* Do the `block` bytes at `lo` read forwards equal those ending at `hi`
+   read backwards? */
+inline bool block_mirrors(const char* lo, const char* hi) {
+    const __m256i reverse = _mm256_setr_epi8(
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi - block));
+
+    // Reverse bytes within each 128-bit lane, then swap the lanes
+    b = _mm256_shuffle_epi8(b, reverse);
+    b = _mm256_permute2x128_si256(b, b, 0x01);
+
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) == -1;
+}
+#elif defined(__SSE2__)
+constexpr size_t block = 16;
+
+inline bool block_mirrors(const char* lo, const char* hi) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi - block));
+
+    // Full byte reversal with SSE2 only: dwords, then words, then bytes
+    b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 1, 2, 3));
+    b = _mm_shufflelo_epi16(b, _MM_SHUFFLE(2, 3, 0, 1));
+    b = _mm_shufflehi_epi16(b, _MM_SHUFFLE(2, 3, 0, 1));
+    b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+}
+#else
+constexpr size_t block = 8;
+
+inline bool block_mirrors(const char* lo, const char* hi) {
+    uint64_t a, b;
+    std::memcpy(&a, lo, 8);
+    std::memcpy(&b, hi - 8, 8);
+    return a == __builtin_bswap64(b);
+}
+#endif
+
+} // namespace palindrome_detail
+
+template<>
+class Palindrome<DirectScan> {
+public:
+    bool is_palindrome(std::string_view) const;
+    size_t is_palindrome_n(const std::string_view* inputs, size_t n, bool* results) const;
+    void reset_deque() {}
+};
+
+inline bool Palindrome<DirectScan>::is_palindrome(std::string_view s) const {
+    using palindrome_detail::block;
+
+    const char* lo = s.data();
+    const char* hi = s.data() + s.size();
+
+    // Blocks may not overlap, otherwise the middle would be compared twice
+    while (hi - lo >= (ptrdiff_t)(2 * block)) {
+        if (!palindrome_detail::block_mirrors(lo, hi))
+            return false;
+        lo += block;
+        hi -= block;
+    }
+
+    while (hi - lo > 1) {
+        if (*lo++ != *--hi)
+            return false;
+    }
+
+    return true;
+}
+
+inline size_t Palindrome<DirectScan>::is_palindrome_n(const std::string_view* inputs, size_t n,
+                                                      bool* results) const {
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        // Both ends of the next string are the first bytes it will touch
+        if (i + 1 < n && !inputs[i + 1].empty()) {
+            __builtin_prefetch(inputs[i + 1].data());
+            __builtin_prefetch(inputs[i + 1].data() + inputs[i + 1].size() - 1);
+        }
+        count += results[i] = is_palindrome(inputs[i]);
+    }
+
+    return count;
+}
+
+/* Decide palindromicity of input that arrives in chunks, in O(1) memory.
+ *
+ * Two polynomial hashes modulo the Mersenne prime 2^61 - 1 are kept: the
+ * forward hash of the input, F = sum s[i] * b^(n-1-i), and the forward
+ * hash of its reverse, R = sum s[i] * b^i. Both can be extended one byte
+ * at a time without looking back, and F == R exactly when the input is a
+ * palindrome, except when `b` is one of the at most n - 1 roots of F - R.
+ * `b` is taken as 2 + seed mod (2^61 - 4); the default constructor draws
+ * a 64-bit seed, so `b` is close to uniform over its 2^61 - 4 values and
+ * a false positive has probability about (n - 1) / 2^61. A caller's seed
+ * is only as good as its entropy: with k random bits the bound is
+ * (n - 1) / 2^k. Use `verify_palindrome` on seekable input when that is
+ * not good enough.
+ *
+ * Bytes are folded in eight at a time using precomputed powers of `b`, so
+ * the serial dependency is one modular multiply per eight bytes rather
+ * than one per byte. */
+class StreamingPalindrome {
+public:
+    StreamingPalindrome() : StreamingPalindrome(random_seed()) {}
+    explicit StreamingPalindrome(uint64_t seed);
+
+    void update(std::string_view chunk);
+    bool is_palindrome() const { return forward == backward; }
+    uint64_t size() const { return length; }
+    void reset();
+
+private:
+    static constexpr uint64_t mod = (uint64_t(1) << 61) - 1;
+
+    uint64_t base;
+    uint64_t pw[9];         // base^0 .. base^8
+    uint64_t forward = 0;
+    uint64_t backward = 0;
+    uint64_t power = 1;     // base^length
+    uint64_t length = 0;
+
+    static uint64_t random_seed();
+    static uint64_t reduce(unsigned __int128 x);
+    static uint64_t mul(uint64_t a, uint64_t b) { return reduce((unsigned __int128)a * b); }
+    static uint64_t add(uint64_t a, uint64_t b);
+};
+
+// random_device yields 32 bits per call; one draw would leave only 2^32 bases
+inline uint64_t StreamingPalindrome::random_seed() {
+    std::random_device rd;
+    uint64_t hi = rd();
+    return hi << 32 | rd();
+}
+
+inline StreamingPalindrome::StreamingPalindrome(uint64_t seed) : base(2 + seed % (mod - 3)) {
+    pw[0] = 1;
+    for (int k = 1; k <= 8; k++)
+        pw[k] = mul(pw[k - 1], base);
+}
+
+inline uint64_t StreamingPalindrome::reduce(unsigned __int128 x) {
+    // 2^61 = 1 (mod 2^61 - 1), so the 61-bit limbs can simply be added
+    uint64_t r = (uint64_t)(x & mod) + (uint64_t)((x >> 61) & mod) + (uint64_t)(x >> 122);
+    r = (r & mod) + (r >> 61);
+    return r >= mod ? r - mod : r;
+}
+
+inline uint64_t StreamingPalindrome::add(uint64_t a, uint64_t b) {
+    uint64_t r = a + b;
+    return r >= mod ? r - mod : r;
+}
+
+inline void StreamingPalindrome::update(std::string_view chunk) {
+    uint64_t f = forward, r = backward, p = power;
+    const unsigned char* c = reinterpret_cast<const unsigned char*>(chunk.data());
+    size_t i = 0;
+
+    for (; i + 8 <= chunk.size(); i += 8, c += 8) {
+        unsigned __int128 sf = 0, sr = 0;
+        for (int k = 0; k < 8; k++) {
+            sf += (unsigned __int128)c[k] * pw[7 - k];
+            sr += (unsigned __int128)c[k] * pw[k];
+        }
+
+        f = reduce((unsigned __int128)f * pw[8] + sf);
+        r = add(r, mul(p, reduce(sr)));
+        p = mul(p, pw[8]);
+    }
+
+    for (; i < chunk.size(); i++, c++) {
+        f = add(mul(f, base), *c);
+        r = add(r, mul(*c, p));
+        p = mul(p, base);
+    }
+
+    forward = f;
+    backward = r;
+    power = p;
+    length += chunk.size();
+}
+
+inline void StreamingPalindrome::reset() {
+    forward = backward = 0;
+    power = 1;
+    length = 0;
+}
+
+/* Exact check of the `n` bytes starting at the current position of a
+ * seekable stream, holding at most two chunks in memory: one read forward
+ * from the front and one read backward from the back. */
+inline bool verify_palindrome(std::istream& in, uint64_t n, size_t chunk_size = 1 << 16) {
+    std::vector<char> front(chunk_size), back(chunk_size);
+    std::istream::pos_type start = in.tellg();
+    uint64_t lo = 0, hi = n;
+
+    while (hi - lo > 1) {
+        size_t len = (size_t)std::min<uint64_t>(chunk_size, (hi - lo) / 2);
+        if (len == 0)
+            break;
+
+        in.seekg(start + (std::streamoff)lo);
+        in.read(front.data(), len);
+        in.seekg(start + (std::streamoff)(hi - len));
+        in.read(back.data(), len);
+
+        if (!in || !std::equal(front.begin(), front.begin() + len,
+                               std::make_reverse_iterator(back.begin() + len)))
+            return false;
+
+        lo += len;
+        hi -= len;
+    }
+
+    return true;
+}
+
+/* Hash everything `in` has to offer, `chunk_size` bytes at a time. If the
+   hashes say it is a palindrome and `verify` is set, rewind and confirm it
+   exactly; that needs a seekable stream. */
+inline bool is_palindrome_stream(std::istream& in, bool verify = false,
+                                 size_t chunk_size = 1 << 16) {
+    std::istream::pos_type start = in.tellg();
+    StreamingPalindrome sp;
+    std::vector<char> buf(chunk_size);
+
+    while (in) {
+        in.read(buf.data(), buf.size());
+        sp.update(std::string_view(buf.data(), (size_t)in.gcount()));
+    }
+
+    if (!sp.is_palindrome() || !verify)
+        return sp.is_palindrome();
+
+    in.clear();
+    in.seekg(start);
+    return verify_palindrome(in, sp.size(), chunk_size);
+}
+
+#endif // _PALINDROME_H
@@ -1,4 +1,9 @@
 #include <vector>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include <functional>
 
 #include "deque.hpp"
 
@@ -163,6 +168,227 @@ TEST_CASE("Index operation", "[ArrayDeque]") {
     //}
 }
 
+struct Counted {
+    static size_t default_ctors, copies, moves;
+
+    int value;
+
+    Counted() : value(0) { default_ctors++; }
+    Counted(int v) : value(v) {}
+    Counted(const Counted& o) : value(o.value) { copies++; }
+    Counted(Counted&& o) noexcept : value(o.value) { moves++; }
+    Counted& operator=(const Counted& o) { value = o.value; copies++; return *this; }
+    Counted& operator=(Counted&& o) noexcept { value = o.value; moves++; return *this; }
+
+    static void reset() { default_ctors = copies = moves = 0; }
+};
+
+size_t Counted::default_ctors = 0;
+size_t Counted::copies = 0;
+size_t Counted::moves = 0;
+
+TEST_CASE("Growth never default-constructs or copies", "[ArrayDeque]") {
+    ArrayDeque<Counted> ad;
+    Counted::reset();
+
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 2) ad.emplace_back(i);
+        else       ad.push_front(Counted{i});
+    }
+
+    REQUIRE(ad.capacity() == 1024);
+    REQUIRE(Counted::default_ctors == 0);
+    REQUIRE(Counted::copies == 0);
+
+    for (int i = 998; i >= 0; i -= 2)
+        REQUIRE(ad.remove_front()->value == i);
+    for (int i = 999; i >= 1; i -= 2)
+        REQUIRE(ad.remove_back()->value == i);
+
+    REQUIRE(Counted::copies == 0);
+}
+
+TEST_CASE("Emplace and rvalue push", "[ArrayDeque]") {
+    ArrayDeque<std::string> ad;
+
+    std::string s(100, 'x');
+    ad.push_back(std::move(s));
+    ad.emplace_front(3, 'a');
+    REQUIRE(ad.emplace_back("tail") == "tail");
+
+    for (int i = 0; i < 200; ++i)
+        ad.push_back(std::to_string(i));
+
+    REQUIRE(ad.size() == 203);
+    REQUIRE(ad[0] == "aaa");
+    REQUIRE(ad[1] == std::string(100, 'x'));
+    REQUIRE(ad[2] == "tail");
+    REQUIRE(ad[202] == "199");
+
+    /* Pushing an element of the deque itself must survive a resize */
+    ArrayDeque<std::string> self;
+    self.push_back("first");
+    for (int i = 0; i < 300; ++i)
+        self.push_back(self[0]);
+
+    REQUIRE(self.size() == 301);
+    REQUIRE(self.remove_back() == "first");
+}
+
+TEST_CASE("Shrink after drain", "[ArrayDeque]") {
+    ArrayDeque<int> ad;
+
+    for (int i = 0; i < 100000; ++i)
+        ad.push_back(i);
+
+    size_t peak = ad.capacity();
+    REQUIRE(peak == 131072);
+
+    for (int i = 0; i < 99990; ++i)
+        REQUIRE(ad.remove_front() == i);
+
+    REQUIRE(ad.capacity() == 64);
+    REQUIRE(ad.size() == 10);
+    for (int i = 0; i < 10; ++i)
+        REQUIRE(ad[i] == 99990 + i);
+
+    /* Hovering around a boundary must not thrash */
+    ArrayDeque<int> hover;
+    for (int i = 0; i < 256; ++i)
+        hover.push_back(i);
+    REQUIRE(hover.capacity() == 512);
+    for (int i = 0; i < 1000; ++i) {
+        hover.remove_back();
+        hover.push_back(i);
+    }
+    REQUIRE(hover.capacity() == 512);
+}
+
+TEST_CASE("Capacity policy", "[ArrayDeque]") {
+    SECTION("shrinking can be disabled") {
+        ArrayDeque<int> ad{DequeCapacityPolicy{64, 0}};
+        for (int i = 0; i < 1000; ++i)
+            ad.push_front(i);
+        while (!ad.empty())
+            ad.remove_back();
+
+        REQUIRE(ad.capacity() == 1024);
+
+        ad.shrink_to_fit();
+        REQUIRE(ad.capacity() == 64);
+    }
+
+    SECTION("capacity stays a power of two") {
+        ArrayDeque<int> ad{DequeCapacityPolicy{100, 8}};
+        REQUIRE(ad.capacity() == 128);
+
+        ad.reserve(1000);
+        REQUIRE(ad.capacity() == 1024);
+
+        for (int i = 0; i < 1000; ++i)
+            ad.push_back(i);
+        REQUIRE(ad.capacity() == 1024);
+
+        for (int i = 0; i < 900; ++i)
+            ad.remove_front();
+        REQUIRE(ad.capacity() == 1024);
+
+        ad.shrink_to_fit();
+        REQUIRE(ad.capacity() == 128);
+        REQUIRE(ad[0] == 900);
+        REQUIRE(ad[99] == 999);
+    }
+
+    SECTION("reserve is a floor for shrinking") {
+        ArrayDeque<int> ad;
+        ad.reserve(1000);
+        REQUIRE(ad.capacity() == 1024);
+
+        ad.push_back(1);
+        ad.push_back(2);
+        ad.remove_front();
+        REQUIRE(ad.capacity() == 1024);
+
+        for (int i = 0; i < 5000; ++i)
+            ad.push_back(i);
+        REQUIRE(ad.capacity() == 8192);
+        for (int i = 0; i < 5000; ++i)
+            ad.remove_back();
+        REQUIRE(ad.capacity() == 1024);
+
+        /* shrink_to_fit drops the floor */
+        ad.shrink_to_fit();
+        REQUIRE(ad.capacity() == 64);
+        for (int i = 0; i < 1000; ++i)
+            ad.push_back(i);
+        while (ad.size() > 1)
+            ad.remove_back();
+        REQUIRE(ad.capacity() == 64);
+        REQUIRE(ad[0] == 2);
+    }
+}
+
+template <typename D>
+void check_bulk_ops() {
+    D d;
+    std::deque<std::string> ref;
+    std::vector<std::string> batch, out(300);
+
+    for (int i = 0; i < 300; ++i)
+        batch.push_back(std::to_string(i));
+
+    /* Interleave single and bulk pushes so the ring wraps and grows */
+    for (int round = 0; round < 20; ++round) {
+        d.push_back_n(batch.data(), 100 + round);
+        ref.insert(ref.end(), batch.begin(), batch.begin() + 100 + round);
+
+        d.push_front_n(batch.data() + 7, 50);
+        ref.insert(ref.begin(), batch.begin() + 7, batch.begin() + 57);
+
+        d.push_front("f" + std::to_string(round));
+        ref.push_front("f" + std::to_string(round));
+
+        size_t k = d.pop_front_n(out.data(), 30);
+        REQUIRE(k == 30);
+        for (size_t i = 0; i < k; ++i) {
+            REQUIRE(out[i] == ref.front());
+            ref.pop_front();
+        }
+
+        k = d.pop_back_n(out.data(), 40);
+        REQUIRE(k == 40);
+        for (size_t i = 0; i < k; ++i)
+            REQUIRE(out[i] == ref[ref.size() - k + i]);
+        ref.erase(ref.end() - k, ref.end());
+
+        REQUIRE(d.size() == ref.size());
+    }
+
+    for (size_t i = 0; i < ref.size(); ++i)
+        REQUIRE(d[i] == ref[i]);
+
+    size_t total = d.size();
+    REQUIRE(d.pop_front_n(out.data(), 0) == 0);
+    std::vector<std::string> rest(total + 10);
+    REQUIRE(d.pop_back_n(rest.data(), total + 10) == total);
+    REQUIRE(d.empty());
+    REQUIRE(d.pop_front_n(rest.data(), 1) == 0);
+    REQUIRE(std::equal(ref.begin(), ref.end(), rest.begin()));
+}
+
+TEST_CASE("Bulk push and pop", "[ArrayDeque]") {
+    check_bulk_ops<ArrayDeque<std::string>>();
+
+    ArrayDeque<int> ad;
+    std::vector<int> xs(1000), ys(1000);
+    std::iota(xs.begin(), xs.end(), 0);
+
+    ad.push_back_n(xs.data(), 1000);
+    REQUIRE(ad.capacity() == 1024);
+    REQUIRE(ad.pop_front_n(ys.data(), 1000) == 1000);
+    REQUIRE(xs == ys);
+}
+
 TEST_CASE("It works", "[deque]") {
     REQUIRE(2 + 2 == 4);
 }
@@ -287,3 +513,191 @@ TEST_CASE("Index operator", "[deque]") {
 
     REQUIRE(it->value.value() == j + 1337);
 }
+
+TEST_CASE("Bulk push and pop on ListDeque", "[deque]") {
+    check_bulk_ops<ListDeque<std::string>>();
+}
+
+TEST_CASE("Links stay consistent after removal", "[deque]") {
+    ListDeque<int> deque;
+
+    for (auto i = 1; i <= 10; i++)
+        deque.push_back(i);
+
+    deque.remove_front();
+    deque.remove_front();
+    REQUIRE(deque.sentinel->prev->value.value() == 10);
+    REQUIRE(deque.sentinel->next->prev == deque.sentinel);
+
+    deque.remove_back();
+    REQUIRE(deque.remove_back() == 9);
+    REQUIRE(deque.remove_front() == 3);
+}
+
+TEST_CASE("Pooled nodes are recycled", "[deque]") {
+    ListDeque<std::string> deque;
+    std::vector<ListNode<std::string>*> first_round, second_round;
+
+    for (auto i = 0; i < 100; i++) {
+        deque.push_back(std::to_string(i));
+        first_round.push_back(deque.sentinel->prev);
+    }
+    while (!deque.empty())
+        deque.remove_front();
+
+    for (auto i = 0; i < 100; i++) {
+        deque.push_front(std::to_string(i));
+        second_round.push_back(deque.sentinel->next);
+    }
+
+    std::sort(first_round.begin(), first_round.end());
+    std::sort(second_round.begin(), second_round.end());
+    REQUIRE(first_round == second_round);
+    REQUIRE(deque.remove_back() == "0");
+}
+
+TEST_CASE("Heap node allocator", "[deque]") {
+    check_bulk_ops<ListDeque<std::string, HeapNodeAllocator<std::string>>>();
+}
+
+TEST_CASE("ChunkedDeque matches std::deque", "[ChunkedDeque]") {
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> dis(0, 3);
+
+    ChunkedDeque<int, 16> cd;
+    std::deque<int> deq;
+
+    REQUIRE(cd.empty());
+    REQUIRE(cd.remove_front() == std::nullopt);
+    REQUIRE(cd.remove_back() == std::nullopt);
+
+    /* Pushes outnumber removals so the deque grows over block boundaries */
+    for (int i = 0; i < 20000; ++i) {
+        int op = dis(gen);
+
+        if (op == 0 || (op == 3 && i % 3 == 0)) {
+            cd.push_front(i);
+            deq.push_front(i);
+        } else if (op == 1 || (op == 2 && i % 3 == 0)) {
+            cd.push_back(i);
+            deq.push_back(i);
+        } else if (deq.empty()) {
+            REQUIRE(cd.empty());
+        } else if (op == 2) {
+            REQUIRE(cd.remove_front() == deq.front());
+            deq.pop_front();
+        } else {
+            REQUIRE(cd.remove_back() == deq.back());
+            deq.pop_back();
+        }
+    }
+
+    REQUIRE(cd.size() == deq.size());
+    for (size_t i = 0; i < deq.size(); ++i)
+        REQUIRE(cd[i] == deq[i]);
+
+    while (!deq.empty()) {
+        REQUIRE(cd.remove_back() == deq.back());
+        deq.pop_back();
+    }
+    REQUIRE(cd.empty());
+}
+
+TEST_CASE("ChunkedDeque keeps element addresses stable", "[ChunkedDeque]") {
+    ChunkedDeque<std::string> cd;
+
+    cd.push_back("anchor");
+    std::string* anchor = &cd[0];
+
+    for (int i = 0; i < 50000; ++i) {
+        cd.push_back(std::to_string(i));
+        cd.emplace_front(5, 'f');
+    }
+
+    REQUIRE(&cd[50000] == anchor);
+    REQUIRE(*anchor == "anchor");
+
+    std::vector<std::string> out(100);
+    REQUIRE(cd.pop_front_n(out.data(), 100) == 100);
+    REQUIRE(out[99] == "fffff");
+    REQUIRE(&cd[49900] == anchor);
+}
+
+/* Rotate the ring so the elements straddle the end of the buffer */
+static void fill_wrapped(ArrayDeque<int>& d, int n) {
+    for (int i = 0; i < 40; i++)
+        d.push_back(-1);
+    for (int i = 0; i < 40; i++)
+        d.remove_front();
+    for (int i = 0; i < n; i++)
+        d.push_back(n - i);
+}
+
+TEST_CASE("ArrayDeque iterators work with standard algorithms", "[ArrayDeque]") {
+    ArrayDeque<int> d;
+    fill_wrapped(d, 50);
+
+    bool wrapped = false;
+    d.for_each_segment([&](auto, auto second) { wrapped = !second.empty(); });
+    REQUIRE(wrapped);
+
+    REQUIRE(std::distance(d.begin(), d.end()) == 50);
+    REQUIRE(std::accumulate(d.begin(), d.end(), 0) == 50 * 51 / 2);
+
+    std::sort(d.begin(), d.end());
+    for (int i = 0; i < 50; i++)
+        REQUIRE(d[i] == i + 1);
+
+    std::reverse(d.begin(), d.end());
+    int expected = 50;
+    for (int x : d)
+        REQUIRE(x == expected--);
+
+    auto it = d.begin();
+    REQUIRE(*(it + 30) == 20);
+    REQUIRE((it + 30)[-5] == 25);
+    REQUIRE((d.end() - 1) - it == 49);
+    REQUIRE(it < it + 1);
+    REQUIRE(std::lower_bound(d.begin(), d.end(), 10, std::greater<int>()) - d.begin() == 40);
+
+    const ArrayDeque<int>& cd = d;
+    ArrayDeque<int>::const_iterator ci = d.begin();
+    REQUIRE(ci == cd.begin());
+    REQUIRE(std::equal(cd.cbegin(), cd.cend(), d.begin()));
+}
+
+TEST_CASE("ArrayDeque iterators on an empty deque", "[ArrayDeque]") {
+    ArrayDeque<int> d;
+    REQUIRE(d.begin() == d.end());
+
+    d.push_front(1);
+    d.remove_back();
+    REQUIRE(d.begin() == d.end());
+    REQUIRE(d.end() - d.begin() == 0);
+}
+
+TEST_CASE("ArrayDeque segments cover the elements in order", "[ArrayDeque]") {
+    ArrayDeque<int> d;
+
+    for (int n : { 0, 1, 50, 63 }) {
+        fill_wrapped(d, n);
+
+        std::vector<int> seen;
+        d.for_each_segment([&](auto first, auto second) {
+            seen.insert(seen.end(), first.begin(), first.end());
+            seen.insert(seen.end(), second.begin(), second.end());
+        });
+        REQUIRE(seen == std::vector<int>(d.begin(), d.end()));
+        REQUIRE(seen.size() == (size_t)n);
+
+        const ArrayDeque<int>& cd = d;
+        size_t total = 0;
+        cd.for_each_segment([&](ArraySegment<const int> a, ArraySegment<const int> b) {
+            total = a.size() + b.size();
+        });
+        REQUIRE(total == (size_t)n);
+
+        while (!d.empty())
+            d.remove_back();
+    }
+}
@@ -1,3 +1,10 @@
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "palindrome.hpp"
 
 #define CATCH_CONFIG_MAIN
@@ -26,3 +33,114 @@ TEST_CASE("Is palindrome? ListDeque", "[palindrome]") {
 
     REQUIRE(!p.is_palindrome(s));
 }
+
+TEST_CASE("State does not leak between calls", "[palindrome]") {
+    Palindrome<ListDeque<char>> p;
+
+    REQUIRE(!p.is_palindrome("abcdef"));
+    REQUIRE(p.is_palindrome("racecar"));
+    REQUIRE(p.is_palindrome(""));
+}
+
+TEST_CASE("Is palindrome? DirectScan", "[palindrome]") {
+    Palindrome<DirectScan> p;
+
+    std::string s{"able was I ere I saw elba"};
+
+    REQUIRE(p.is_palindrome(s));
+
+    s += '.';
+
+    REQUIRE(!p.is_palindrome(s));
+    REQUIRE(p.is_palindrome(""));
+    REQUIRE(p.is_palindrome("x"));
+}
+
+TEST_CASE("DirectScan agrees with the deque version", "[palindrome]") {
+    Palindrome<ArrayDeque<char>> slow;
+    Palindrome<DirectScan> fast;
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> letter('a', 'c');
+
+    std::vector<std::string> inputs;
+    for (size_t len = 0; len < 200; ++len) {
+        std::string half;
+        for (size_t i = 0; i < len / 2; ++i)
+            half += (char)letter(gen);
+
+        std::string pal = half;
+        if (len % 2) pal += 'm';
+        pal.append(half.rbegin(), half.rend());
+        inputs.push_back(pal);
+
+        /* Break the mirror at every position in turn */
+        for (size_t i = 0; i < pal.size(); i += 7) {
+            std::string broken = pal;
+            broken[i] = 'z';
+            inputs.push_back(broken);
+        }
+    }
+
+    std::vector<std::string_view> views(inputs.begin(), inputs.end());
+    std::unique_ptr<bool[]> batch(new bool[views.size()]);
+    size_t count = fast.is_palindrome_n(views.data(), views.size(), batch.get());
+
+    size_t expected = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        bool want = slow.is_palindrome(inputs[i]);
+        expected += want;
+        REQUIRE(fast.is_palindrome(inputs[i]) == want);
+        REQUIRE(batch[i] == want);
+    }
+    REQUIRE(count == expected);
+}
+
+TEST_CASE("Streaming hashes match the direct check", "[palindrome]") {
+    Palindrome<DirectScan> direct;
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> letter('a', 'b');
+
+    for (size_t len = 0; len < 300; len += 3) {
+        std::string half;
+        for (size_t i = 0; i < len / 2; ++i)
+            half += (char)letter(gen);
+        std::string pal = half + (len % 2 ? "q" : "") + std::string(half.rbegin(), half.rend());
+        std::string broken = pal + "ab";
+
+        for (auto& s : { pal, broken }) {
+            /* Feed it in uneven chunks */
+            StreamingPalindrome sp(len);
+            for (size_t i = 0; i < s.size(); i += 1 + i % 5)
+                sp.update(std::string_view(s).substr(i, 1 + i % 5));
+
+            REQUIRE(sp.size() == s.size());
+            REQUIRE(sp.is_palindrome() == direct.is_palindrome(s));
+        }
+    }
+}
+
+TEST_CASE("Streaming over an istream with verification", "[palindrome]") {
+    std::string pal(100000, 'x');
+    for (size_t i = 0; i < pal.size() / 2; ++i)
+        pal[i] = pal[pal.size() - 1 - i] = (char)('a' + i % 26);
+
+    std::istringstream in1(pal);
+    REQUIRE(is_palindrome_stream(in1, false, 4096));
+
+    std::istringstream in2(pal);
+    REQUIRE(is_palindrome_stream(in2, true, 1000));
+
+    std::istringstream in3(pal);
+    REQUIRE(verify_palindrome(in3, pal.size(), 333));
+
+    pal[777] = '!';
+    std::istringstream in4(pal);
+    REQUIRE(!is_palindrome_stream(in4, true, 1000));
+
+    std::istringstream in5(pal);
+    REQUIRE(!verify_palindrome(in5, pal.size(), 333));
+
+    std::istringstream empty("");
+    REQUIRE(is_palindrome_stream(empty, true));
+}
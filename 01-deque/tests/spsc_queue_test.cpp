@@ -0,0 +1,98 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Construction", "[SPSCQueue]") {
+    SPSCQueue<int> q(100);
+
+    REQUIRE(q.capacity() == 128);
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.empty());
+    REQUIRE(q.try_pop() == std::nullopt);
+}
+
+TEST_CASE("Full and empty", "[SPSCQueue]") {
+    SPSCQueue<std::string> q(4);
+
+    for (int i = 0; i < 4; ++i)
+        REQUIRE(q.try_push(std::to_string(i)));
+    REQUIRE(!q.try_push("overflow"));
+    REQUIRE(q.size() == 4);
+
+    REQUIRE(q.try_pop() == "0");
+    REQUIRE(q.try_emplace(3, 'x'));
+
+    for (auto s : { "1", "2", "3", "xxx" })
+        REQUIRE(q.try_pop() == s);
+    REQUIRE(q.try_pop() == std::nullopt);
+}
+
+TEST_CASE("Batch push and pop wrap around", "[SPSCQueue]") {
+    SPSCQueue<int> q(16);
+    std::vector<int> in(16), out(16);
+    int next_in = 0, next_out = 0;
+
+    for (int round = 0; round < 100; ++round) {
+        size_t want = 1 + round % 13;
+        for (size_t i = 0; i < want; ++i)
+            in[i] = next_in + (int)i;
+
+        size_t pushed = q.push_n(in.data(), want);
+        REQUIRE(pushed <= want);
+        next_in += (int)pushed;
+
+        size_t popped = q.pop_n(out.data(), 1 + round % 7);
+        for (size_t i = 0; i < popped; ++i)
+            REQUIRE(out[i] == next_out++);
+    }
+
+    while (auto v = q.try_pop())
+        REQUIRE(*v == next_out++);
+    REQUIRE(next_out == next_in);
+}
+
+TEST_CASE("Two threads hand off in order", "[SPSCQueue]") {
+    const int N = 200000;
+    SPSCQueue<std::string> q(64);
+
+    std::thread producer([&] {
+        std::vector<std::string> batch;
+        for (int i = 0; i < N; ) {
+            if (i % 2) {
+                if (q.try_push(std::to_string(i)))
+                    i++;
+                else
+                    std::this_thread::yield();
+            } else {
+                batch.clear();
+                for (int j = i; j < std::min(N, i + 10); ++j)
+                    batch.push_back(std::to_string(j));
+                size_t k = q.push_n(batch.data(), batch.size());
+                i += (int)k;
+                if (k == 0)
+                    std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<std::string> out(32);
+    int expected = 0;
+    bool in_order = true;
+    while (expected < N) {
+        size_t k = q.pop_n(out.data(), out.size());
+        if (k == 0)
+            std::this_thread::yield();
+        for (size_t i = 0; i < k; ++i)
+            in_order &= (out[i] == std::to_string(expected++));
+    }
+
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(q.empty());
+}
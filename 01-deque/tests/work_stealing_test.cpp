@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "work_stealing_deque.hpp"
+#include "thread_pool.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Owner pops LIFO, thieves steal FIFO", "[WorkStealingDeque]") {
+    WorkStealingDeque<int> d(4);
+
+    REQUIRE(d.empty());
+    REQUIRE(d.pop() == std::nullopt);
+    REQUIRE(d.steal() == std::nullopt);
+
+    for (int i = 0; i < 100; ++i)
+        d.push(i);
+
+    REQUIRE(d.size() == 100);
+    REQUIRE(d.capacity() == 128);
+
+    REQUIRE(d.steal() == 0);
+    REQUIRE(d.steal() == 1);
+    REQUIRE(d.pop() == 99);
+    REQUIRE(d.pop() == 98);
+
+    for (int i = 2; i < 98; ++i)
+        REQUIRE(d.steal() == i);
+
+    REQUIRE(d.pop() == std::nullopt);
+    REQUIRE(d.steal() == std::nullopt);
+}
+
+TEST_CASE("Every element is taken exactly once", "[WorkStealingDeque]") {
+    const int N = 200000;
+    const int thieves = 3;
+
+    WorkStealingDeque<int> d;
+    std::vector<std::atomic<int>> taken(N);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> ts;
+    for (int i = 0; i < thieves; ++i) {
+        ts.emplace_back([&] {
+            while (!done.load() || !d.empty()) {
+                if (auto x = d.steal())
+                    taken[*x]++;
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    /* The owner interleaves pushes (which grow the array) with pops */
+    for (int i = 0; i < N; ++i) {
+        d.push(i);
+        if (i % 3 == 0)
+            if (auto x = d.pop())
+                taken[*x]++;
+    }
+    while (auto x = d.pop())
+        taken[*x]++;
+
+    done = true;
+    for (auto& t : ts)
+        t.join();
+
+    REQUIRE(std::all_of(taken.begin(), taken.end(), [](auto& c) { return c.load() == 1; }));
+}
+
+static long parallel_sum(ThreadPool& pool, const long* xs, size_t n) {
+    if (n <= 1024)
+        return std::accumulate(xs, xs + n, 0L);
+
+    long left = 0, right = 0;
+    TaskGroup g(pool);
+    g.spawn([&] { left = parallel_sum(pool, xs, n / 2); });
+    right = parallel_sum(pool, xs + n / 2, n - n / 2);
+    g.wait();
+
+    return left + right;
+}
+
+TEST_CASE("Fork/join on the thread pool", "[ThreadPool]") {
+    std::vector<long> xs(1 << 20);
+    std::iota(xs.begin(), xs.end(), 0);
+    long expected = std::accumulate(xs.begin(), xs.end(), 0L);
+
+    for (size_t threads : { 1, 2, 4 }) {
+        ThreadPool pool(threads);
+        REQUIRE(pool.size() == threads);
+
+        for (int round = 0; round < 3; ++round) {
+            long sum = 0;
+            pool.run([&] { sum = parallel_sum(pool, xs.data(), xs.size()); });
+            REQUIRE(sum == expected);
+        }
+    }
+}
+
+TEST_CASE("Task exceptions reach the waiter", "[ThreadPool]") {
+    ThreadPool pool(2);
+    std::atomic<int> ran{0};
+
+    REQUIRE_THROWS_AS(pool.run([&] {
+        TaskGroup g(pool);
+        for (int i = 0; i < 100; ++i)
+            g.spawn([&, i] {
+                ran++;
+                if (i == 42) throw std::runtime_error("boom");
+            });
+        g.wait();
+    }), std::runtime_error);
+
+    REQUIRE(ran == 100);
+}
+
+static double cpu_seconds() {
+    rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+TEST_CASE("Idle threads sleep during a long serial task", "[ThreadPool]") {
+    ThreadPool pool(4);
+    pool.run([] {});    // let the workers go idle
+
+    // One task sleeps 300 ms while three workers and the caller have
+    // nothing to do; spinning would cost about that much CPU per thread
+    double before = cpu_seconds();
+    pool.run([] { std::this_thread::sleep_for(std::chrono::milliseconds(300)); });
+    double used = cpu_seconds() - before;
+
+    REQUIRE(used < 0.1);
+
+    // Sleepers still wake for new work and finished groups
+    std::atomic<int> ran{0};
+    for (int round = 0; round < 200; ++round) {
+        pool.run([&] {
+            TaskGroup g(pool);
+            for (int i = 0; i < 8; ++i)
+                g.spawn([&] { ran++; });
+            g.wait();
+        });
+    }
+    REQUIRE(ran == 1600);
+}
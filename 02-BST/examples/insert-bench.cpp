@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "BST.hpp"
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/* Insert, look up and tear down a tree built from `keys` */
+static void run(const char* name, const std::vector<int>& keys) {
+    BST<int> bt;
+    size_t found = 0;
+
+    double insert_ms = elapsed_ms([&] {
+        for (int k : keys)
+            bt.insert(k);
+    });
+    double search_ms = elapsed_ms([&] {
+        for (int k : keys)
+            found += bt.search(k);
+    });
+    double clear_ms = elapsed_ms([&] { bt.clear(); });
+
+    std::printf("%-8s %10zu %12.1f %12.1f %10.1f %10zu\n",
+                name, keys.size(), insert_ms, search_ms, clear_ms, found);
+}
+
+/* usage: insert-bench [random keys] [sorted keys]
+ *
+ * The tree is unbalanced, so sorted input costs O(n^2) overall; the
+ * sorted run defaults to a size that finishes in seconds while still
+ * building a chain tens of thousands of nodes deep. */
+int main(int argc, char** argv) {
+    size_t n_random = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    size_t n_sorted = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1 << 16;
+
+    std::vector<int> random_keys(n_random);
+    std::iota(random_keys.begin(), random_keys.end(), 0);
+    std::shuffle(random_keys.begin(), random_keys.end(), std::mt19937(42));
+
+    std::vector<int> sorted_keys(n_sorted);
+    std::iota(sorted_keys.begin(), sorted_keys.end(), 0);
+
+    std::printf("%-8s %10s %12s %12s %10s %10s\n",
+                "input", "keys", "insert ms", "search ms", "clear ms", "found");
+
+    run("random", random_keys);
+    run("sorted", sorted_keys);
+
+    return 0;
+}
@@ -4,6 +4,12 @@
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <future>
+#include <thread>
+#include <cstddef>
 
 
 template <typename T>
@@ -22,168 +28,866 @@ class TreeNode
 };
 
 
-template <typename T>
+/* Immutable sorted set in Eytzinger (BFS) order: the children of slot k
+ * are 2k and 2k+1 in one contiguous 1-based array, so a lookup walks a
+ * dense array with no pointers, and the next few levels can be
+ * prefetched as one cache line. Build one with BST::freeze() for
+ * read-mostly data. */
+template <typename T, typename Compare = std::less<T>>
+class EytzingerSet
+{
+    public:
+        class const_iterator;
+
+        EytzingerSet() = default;
+
+        // The keys must be strictly increasing under `comp`
+        explicit EytzingerSet(std::vector<T> sorted, const Compare& comp = Compare());
+
+        template <typename InputIt>
+        EytzingerSet(InputIt first, InputIt last, const Compare& comp = Compare())
+            : EytzingerSet(std::vector<T>(first, last), comp) {}
+
+        size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+
+        const_iterator begin() const { return const_iterator(this, leftmost(1)); }
+        const_iterator end() const { return const_iterator(this, 0); }
+
+        bool contains(const T& key) const;
+        const_iterator lower_bound(const T& key) const;   // first element >= key
+        const_iterator upper_bound(const T& key) const;   // first element > key
+
+    private:
+        std::vector<T> slots;   // slots[0] is unused
+        size_t n = 0;
+        Compare comp;
+
+        size_t leftmost(size_t k) const;
+        size_t successor(size_t k) const;
+        size_t predecessor(size_t k) const;
+
+        template <typename Less>
+        size_t descend(Less less) const;
+};
+
+/* Bidirectional iterator in key order. Stepping moves between Eytzinger
+ * slots with shifts; slot 0 stands for end(). */
+template <typename T, typename Compare>
+class EytzingerSet<T, Compare>::const_iterator
+{
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return set->slots[k]; }
+        pointer operator->() const { return &set->slots[k]; }
+
+        const_iterator& operator++() { k = set->successor(k); return *this; }
+        const_iterator& operator--() { k = set->predecessor(k); return *this; }
+        const_iterator operator++(int) { auto t = *this; ++*this; return t; }
+        const_iterator operator--(int) { auto t = *this; --*this; return t; }
+
+        bool operator==(const const_iterator& o) const { return k == o.k; }
+        bool operator!=(const const_iterator& o) const { return k != o.k; }
+
+    private:
+        friend class EytzingerSet<T, Compare>;
+
+        const EytzingerSet<T, Compare>* set = nullptr;
+        size_t k = 0;
+
+        const_iterator(const EytzingerSet<T, Compare>* s, size_t k) : set(s), k(k) {}
+};
+
+template <typename T, typename Compare>
+EytzingerSet<T, Compare>::EytzingerSet(std::vector<T> sorted, const Compare& comp)
+    : comp(comp) {
+    n = sorted.size();
+    slots.resize(n + 1);
+
+    // Visit the slots in key order and hand out the sorted keys
+    size_t k = leftmost(1);
+    for (auto& key : sorted) {
+        slots[k] = std::move(key);
+        k = successor(k);
+    }
+}
+
+template <typename T, typename Compare>
+size_t EytzingerSet<T, Compare>::leftmost(size_t k) const {
+    if (k > n) return 0;
+
+    while (2 * k <= n)
+        k = 2 * k;
+
+    return k;
+}
+
+template <typename T, typename Compare>
+size_t EytzingerSet<T, Compare>::successor(size_t k) const {
+    if (2 * k + 1 <= n)
+        return leftmost(2 * k + 1);
+
+    // Climb past every ancestor we are the right child of, then one
+    // more; that lands on 0 from the rightmost slot
+    while (k & 1)
+        k >>= 1;
+
+    return k >> 1;
+}
+
+template <typename T, typename Compare>
+size_t EytzingerSet<T, Compare>::predecessor(size_t k) const {
+    // --end() is the largest key
+    if (k == 0) {
+        k = n == 0 ? 0 : 1;
+        while (2 * k + 1 <= n)
+            k = 2 * k + 1;
+        return k;
+    }
+
+    if (2 * k <= n) {
+        k = 2 * k;
+        while (2 * k + 1 <= n)
+            k = 2 * k + 1;
+        return k;
+    }
+
+    while (k > 1 && !(k & 1))
+        k >>= 1;
+
+    return k >> 1;
+}
+
+/* Walk down to a leaf, going right whenever `less(slot)`. The last slot
+   where we went left is the first one for which `less` is false. */
+template <typename T, typename Compare>
+template <typename Less>
+size_t EytzingerSet<T, Compare>::descend(Less less) const {
+    // Slots 16k .. 16k+15 hold the descendants four levels down; for
+    // small T they share a cache line or two
+    constexpr size_t prefetch_stride = 16;
+
+    size_t k = 1;
+
+    while (k <= n) {
+#if defined(__GNUC__)
+        if (prefetch_stride * k <= n)
+            __builtin_prefetch(slots.data() + prefetch_stride * k);
+#endif
+        k = 2 * k + (less(slots[k]) ? 1 : 0);
+    }
+
+    // Undo the trailing right turns and the final left turn
+    while (k & 1)
+        k >>= 1;
+
+    return k >> 1;
+}
+
+template <typename T, typename Compare>
+typename EytzingerSet<T, Compare>::const_iterator EytzingerSet<T, Compare>::lower_bound(const T& key) const {
+    return const_iterator(this, descend([&](const T& x) { return comp(x, key); }));
+}
+
+template <typename T, typename Compare>
+typename EytzingerSet<T, Compare>::const_iterator EytzingerSet<T, Compare>::upper_bound(const T& key) const {
+    return const_iterator(this, descend([&](const T& x) { return !comp(key, x); }));
+}
+
+template <typename T, typename Compare>
+bool EytzingerSet<T, Compare>::contains(const T& key) const {
+    size_t k = descend([&](const T& x) { return comp(x, key); });
+
+    return k != 0 && !comp(key, slots[k]);
+}
+
+
+template <typename T, typename Compare = std::less<T>>
 struct BST
 {
     public:
         std::unique_ptr<TreeNode<T>> root = nullptr;
 
-        ~BST() {}
+        BST() = default;
+        explicit BST(const Compare& comp) : comp(comp) {}
+        ~BST() { clear(); }
 
         bool insert(const T& key);
         bool search(const T& key);
         bool remove(const T& key);
 
+        // Lookups by any key type that Compare can order against T.
+        // These overloads exist only when Compare::is_transparent is
+        // defined (std::less<> for instance), so a std::string tree can
+        // be probed with a std::string_view without building a string.
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        bool search(const K& key);
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        bool remove(const K& key);
+
+        void clear();
+
+        // Immutable, pointer-free copy of the current keys for fast reads
+        EytzingerSet<T, Compare> freeze() const;
+
+        // Ordered traversal. Iterators are invalidated by any insert or
+        // remove.
+        class const_iterator;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator lower_bound(const T& key) const;   // first key >= key
+        const_iterator upper_bound(const T& key) const;   // first key > key
+        const_iterator find(const T& key) const;          // end() if absent
+
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator lower_bound(const K& key) const;
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator upper_bound(const K& key) const;
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator find(const K& key) const;
+
+        // Call f(key) for every key in [lo, hi), in order
+        template <typename F>
+        void for_each_in_range(const T& lo, const T& hi, F&& f) const;
+
+        // Replace the contents with the strictly increasing range
+        // [first, last), built bottom-up as a perfectly balanced tree
+        // in O(n) without a single comparison
+        template <typename RandomIt>
+        void from_sorted(RandomIt first, RandomIt last);
+
+        // Same as from_sorted, building disjoint subtrees on up to
+        // `threads` threads
+        template <typename RandomIt>
+        void from_sorted_parallel(RandomIt first, RandomIt last,
+                                  unsigned threads = std::thread::hardware_concurrency());
+
     private:
+        Compare comp;
+
+        // Subtrees smaller than this are not worth a thread
+        static constexpr size_t parallel_cutoff = 1 << 14;
+
+        template <typename GoRight>
+        const_iterator descend(GoRight go_right) const;
+
+        template <typename K>
+        const_iterator lower_bound_of(const K& key) const;
+        template <typename K>
+        const_iterator upper_bound_of(const K& key) const;
+        template <typename K>
+        const_iterator find_of(const K& key) const;
+
+        template <typename RandomIt>
+        static std::unique_ptr<TreeNode<T>> build_sorted(RandomIt first, RandomIt last, unsigned threads);
+
         bool insert(std::unique_ptr<TreeNode<T>>& t, const T& key);
-        bool search(std::unique_ptr<TreeNode<T>>& t, const T& key);
-        bool remove(std::unique_ptr<TreeNode<T>>& t, const T& key);
+        template <typename K>
+        bool search(std::unique_ptr<TreeNode<T>>& t, const K& key);
+        template <typename K>
+        bool remove(std::unique_ptr<TreeNode<T>>& t, const K& key);
 
-        // you can define find_right_most_key function
+        // Follow the child links from `t` down to the link that holds
+        // `key`, or to the empty link where it would be inserted
+        template <typename K>
+        std::unique_ptr<TreeNode<T>>* find_link(std::unique_ptr<TreeNode<T>>& t, const K& key);
+        std::unique_ptr<TreeNode<T>>* find_right_most_link(std::unique_ptr<TreeNode<T>>& t);
 
 };
 
-template <typename T>
-bool BST<T>::insert(const T& key) {
+template <typename T, typename Compare>
+bool BST<T, Compare>::insert(const T& key) {
     return insert(root, key);
 }
 
-template <typename T>
-bool BST<T>::search(const T& key) {
+template <typename T, typename Compare>
+bool BST<T, Compare>::search(const T& key) {
     return search(root, key);
 }
 
-template <typename T>
-bool BST<T>::remove(const T& key) {
+template <typename T, typename Compare>
+bool BST<T, Compare>::remove(const T& key) {
     return remove(root, key);
 }
 
-template <typename T>
-bool BST<T>::insert(std::unique_ptr<TreeNode<T>>& t, const T& key) {
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+bool BST<T, Compare>::search(const K& key) {
+    return search(root, key);
+}
 
-    // TODO
-    // if insertion fails (i.e. if the key already exists in tree), return false
-    // otherwise, return true
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+bool BST<T, Compare>::remove(const K& key) {
+    return remove(root, key);
+}
 
-    // If t is the root pointer <=> t == nullptr
-    if (t == nullptr) {
-        // Create root node
-        TreeNode<T>* new_node = new TreeNode<T>(key);
-        // Point to root node
-        t.reset(new_node);
+template <typename T, typename Compare>
+void BST<T, Compare>::clear() {
+    // Destroying `root` directly would free the tree through a chain of
+    // nested ~TreeNode calls, one stack frame per level. Instead rotate
+    // every left child up until the root has none, then drop the root
+    // alone and continue with its right subtree.
+    while (root != nullptr) {
+        if (root->left != nullptr) {
+            std::unique_ptr<TreeNode<T>> l = std::move(root->left);
+            root->left = std::move(l->right);
+            l->right = std::move(root);
+            root = std::move(l);
+        }
+        else {
+            root = std::move(root->right);
+        }
+    }
+}
 
-        return true;
+/* In-order iterator over a BST. It keeps the path of ancestors
+ * still to be visited on an explicit stack, top being the current node,
+ * so ++ is O(1) amortized and never recurses. Keys are read-only. */
+template <typename T, typename Compare>
+class BST<T, Compare>::const_iterator
+{
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return path.back()->element; }
+        pointer operator->() const { return &path.back()->element; }
+
+        const_iterator& operator++() {
+            const TreeNode<T>* n = path.back();
+            path.pop_back();
+            push_left(n->right.get());
+            return *this;
         }
+        const_iterator operator++(int) { auto t = *this; ++*this; return t; }
 
-    // Extract node value
-    T val = t->element;
-
-    // Go left and insert
-    if (key < val) {
-        // Is leaf node? => Insert to the left
-        if (t->left == nullptr) {
-            // Create new node
-            TreeNode<T>* new_node = new TreeNode<T>(key);
-            // Point to new node
-            t->left.reset(new_node);
-            
-            return true;
+        bool operator==(const const_iterator& o) const {
+            return path.empty() ? o.path.empty() : (!o.path.empty() && path.back() == o.path.back());
         }
-        // Traverse down to the left and try insertion
-        else {
-            return insert(t->left, key);
+        bool operator!=(const const_iterator& o) const { return !(*this == o); }
+
+    private:
+        friend struct BST<T, Compare>;
+
+        std::vector<const TreeNode<T>*> path;
+
+        void push_left(const TreeNode<T>* n) {
+            for (; n != nullptr; n = n->left.get())
+                path.push_back(n);
         }
-    }
-    // Go right and insert
-    else if (key > val) {
-        // Is leaf node? => Insert to the right
-        if (t->right == nullptr) {
-            // Create new node
-            TreeNode<T>* new_node = new TreeNode<T>(key);
-            // Point to new node
-            t->right.reset(new_node);
-            
-            return true;
+};
+
+template <typename T, typename Compare>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::begin() const {
+    const_iterator it;
+    it.push_left(root.get());
+    return it;
+}
+
+template <typename T, typename Compare>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::end() const {
+    return const_iterator();
+}
+
+/* Descend as for a search, stacking exactly the nodes where we turned
+   left: they are the ones still ahead of the first key not going right */
+template <typename T, typename Compare>
+template <typename GoRight>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::descend(GoRight go_right) const {
+    const_iterator it;
+    const TreeNode<T>* n = root.get();
+
+    while (n != nullptr) {
+        if (go_right(n->element)) {
+            n = n->right.get();
         }
-        // Traverse down to the right and try insertion
         else {
-            return insert(t->right, key);
+            it.path.push_back(n);
+            n = n->left.get();
         }
     }
-    // Already exists
+
+    return it;
+}
+
+template <typename T, typename Compare>
+template <typename K>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::lower_bound_of(const K& key) const {
+    return descend([&](const T& x) { return comp(x, key); });
+}
+
+template <typename T, typename Compare>
+template <typename K>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::upper_bound_of(const K& key) const {
+    return descend([&](const T& x) { return !comp(key, x); });
+}
+
+template <typename T, typename Compare>
+template <typename K>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::find_of(const K& key) const {
+    const_iterator it = lower_bound_of(key);
+
+    if (it != end() && comp(key, *it))
+        return end();
+
+    return it;
+}
+
+template <typename T, typename Compare>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::lower_bound(const T& key) const {
+    return lower_bound_of(key);
+}
+
+template <typename T, typename Compare>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::upper_bound(const T& key) const {
+    return upper_bound_of(key);
+}
+
+template <typename T, typename Compare>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::find(const T& key) const {
+    return find_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::lower_bound(const K& key) const {
+    return lower_bound_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::upper_bound(const K& key) const {
+    return upper_bound_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename BST<T, Compare>::const_iterator BST<T, Compare>::find(const K& key) const {
+    return find_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename F>
+void BST<T, Compare>::for_each_in_range(const T& lo, const T& hi, F&& f) const {
+    // Subtrees entirely below `lo` are never entered, and the walk stops
+    // at the first key >= hi
+    for (auto it = lower_bound(lo), last = end(); it != last && comp(*it, hi); ++it)
+        f(*it);
+}
+
+template <typename T, typename Compare>
+EytzingerSet<T, Compare> BST<T, Compare>::freeze() const {
+    std::vector<T> sorted;
+    std::vector<const TreeNode<T>*> stack;
+    const TreeNode<T>* t = root.get();
+
+    // In-order walk with an explicit stack; the tree may be deep
+    while (t != nullptr || !stack.empty()) {
+        while (t != nullptr) {
+            stack.push_back(t);
+            t = t->left.get();
+        }
+        t = stack.back();
+        stack.pop_back();
+
+        sorted.push_back(t->element);
+        t = t->right.get();
+    }
+
+    return EytzingerSet<T, Compare>(std::move(sorted), comp);
+}
+
+template <typename T, typename Compare>
+template <typename RandomIt>
+void BST<T, Compare>::from_sorted(RandomIt first, RandomIt last) {
+    clear();
+    root = build_sorted(first, last, 1);
+}
+
+template <typename T, typename Compare>
+template <typename RandomIt>
+void BST<T, Compare>::from_sorted_parallel(RandomIt first, RandomIt last, unsigned threads) {
+    clear();
+    root = build_sorted(first, last, std::max(threads, 1u));
+}
+
+template <typename T, typename Compare>
+template <typename RandomIt>
+std::unique_ptr<TreeNode<T>> BST<T, Compare>::build_sorted(RandomIt first, RandomIt last, unsigned threads) {
+    if (first == last) return nullptr;
+
+    // The middle element becomes the root, so the halves differ in
+    // size by at most one and the depth stays at floor(log2(n))
+    RandomIt mid = first + (last - first) / 2;
+    auto t = std::make_unique<TreeNode<T>>(*mid);
+
+    if (threads > 1 && (size_t)(last - first) >= parallel_cutoff) {
+        // Hand half of the thread budget to the left half
+        auto left = std::async(std::launch::async, build_sorted<RandomIt>,
+                               first, mid, threads / 2);
+        t->right = build_sorted(mid + 1, last, threads - threads / 2);
+        t->left = left.get();
+    }
     else {
-        return false;
+        t->left = build_sorted(first, mid, 1);
+        t->right = build_sorted(mid + 1, last, 1);
     }
+
+    return t;
 }
 
-template <typename T>
-bool BST<T>::search(std::unique_ptr<TreeNode<T>>& t, const T& key) {
+template <typename T, typename Compare>
+template <typename K>
+std::unique_ptr<TreeNode<T>>* BST<T, Compare>::find_link(std::unique_ptr<TreeNode<T>>& t, const K& key) {
+    std::unique_ptr<TreeNode<T>>* link = &t;
+
+    while (*link != nullptr) {
+        const T& val = (*link)->element;
+
+        if      (comp(key, val)) link = &(*link)->left;
+        else if (comp(val, key)) link = &(*link)->right;
+        else                break; // match found
+    }
+
+    return link;
+}
+
+template <typename T, typename Compare>
+std::unique_ptr<TreeNode<T>>* BST<T, Compare>::find_right_most_link(std::unique_ptr<TreeNode<T>>& t) {
+    std::unique_ptr<TreeNode<T>>* link = &t;
+
+    while ((*link)->right != nullptr)
+        link = &(*link)->right;
+
+    return link;
+}
+
+template <typename T, typename Compare>
+bool BST<T, Compare>::insert(std::unique_ptr<TreeNode<T>>& t, const T& key) {
 
     // TODO
-    // if key exists in tree, return true
-    // otherwise, return false
+    // if insertion fails (i.e. if the key already exists in tree), return false
+    // otherwise, return true
 
-    // Empty tree 
-    if (t == nullptr) return false;
+    std::unique_ptr<TreeNode<T>>* link = find_link(t, key);
 
-    // Extract node value
-    T val = t->element;
+    // Already exists
+    if (*link != nullptr) return false;
+
+    // Hang the new node on the empty link
+    link->reset(new TreeNode<T>(key));
 
-    // Traverse down and search
-    if      (key < val) return search(t->left,  key);
-    else if (key > val) return search(t->right, key);
-    else                return true; // match found
+    return true;
 }
 
-template <typename T>
-bool BST<T>::remove(std::unique_ptr<TreeNode<T>>& t, const T& key) {
+template <typename T, typename Compare>
+template <typename K>
+bool BST<T, Compare>::search(std::unique_ptr<TreeNode<T>>& t, const K& key) {
+
+    // TODO
+    // if key exists in tree, return true
+    // otherwise, return false
+
+    return *find_link(t, key) != nullptr;
+}
+
+template <typename T, typename Compare>
+template <typename K>
+bool BST<T, Compare>::remove(std::unique_ptr<TreeNode<T>>& t, const K& key) {
 
     // TODO
     // if key does not exist in tree, return false
     // otherwise, return true
 
-    // Empty tree
-    if (t == nullptr) return false;
+    std::unique_ptr<TreeNode<T>>* link = find_link(t, key);
+
+    // Not in tree
+    if (*link == nullptr) return false;
 
-    // Extract value
-    T val = t->element;
+    std::unique_ptr<TreeNode<T>>& node = *link;
 
-    // Traverse down and search
-    if      (key < val) return remove(t->left,  key);
-    else if (key > val) return remove(t->right, key);
-    
-    // Match found
+    // Has at most one child: bypass the node
+    if (node->left == nullptr) {
+        node = std::move(node->right);
+    }
+    else if (node->right == nullptr) {
+        node = std::move(node->left);
+    }
+    // Has both children
     else {
-        // Is leaf node
-        if (t->left == nullptr && t->right == nullptr) {
-            t.reset(nullptr);
-        }
-        // Has only left child
-        else if (t->left != nullptr && t->right == nullptr) {
-            t.reset(t->left.release());
+        // Find max element from left subtree
+        std::unique_ptr<TreeNode<T>>& max_node = *find_right_most_link(node->left);
+
+        // Propagate max value up, then unlink the max node; it has no
+        // right child, so its left subtree takes its place
+        node->element = std::move(max_node->element);
+        max_node = std::move(max_node->left);
+    }
+
+    return true;
+}
+
+
+/* Node of an ArenaBST. Children are 32-bit slot indices into the
+ * owning NodeArena instead of owning pointers, so a node with an int
+ * key is 12 bytes rather than 24. */
+template <typename T>
+struct ArenaTreeNode
+{
+    T element;
+    uint32_t left = UINT32_MAX;     // NodeArena::nil
+    uint32_t right = UINT32_MAX;
+
+    ArenaTreeNode(const T& e)
+        :element{e} {}
+};
+
+
+/* Chunked slot storage for tree nodes addressed by 32-bit indices.
+ * Chunks hold a fixed power-of-two number of slots, so an index splits
+ * into a chunk number and an offset with one shift and one mask, and
+ * chunks never move once allocated. Freed slots go on an intrusive free
+ * list threaded through their own storage. release() hands every chunk
+ * back at once without visiting the nodes. */
+template <typename Node>
+class NodeArena
+{
+    public:
+        static constexpr uint32_t nil = UINT32_MAX;
+        static constexpr uint32_t chunk_shift = 10;
+        static constexpr uint32_t chunk_nodes = 1u << chunk_shift;
+
+        NodeArena() = default;
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+
+        ~NodeArena() { release(); }
+
+        template <typename... Args>
+        uint32_t create(Args&&... args);
+        void destroy(uint32_t idx);
+
+        Node& operator[](uint32_t idx) {
+            return *reinterpret_cast<Node*>(slot(idx).storage);
         }
-        // Has only left child
-        else if (t->left == nullptr && t->right != nullptr) {
-            t.reset(t->right.release());
+        const Node& operator[](uint32_t idx) const {
+            return *reinterpret_cast<const Node*>(slot(idx).storage);
         }
-        // Has both children
-        else {
-            // Find max element from left subtree
-            T max_val;
-            TreeNode<T>* np = t->left.get(); 
-
-            // point np to the last node before max node
-            while (np->right != nullptr) {
-                np = np->right.get();
-            }
-
-            max_val = np->element; // Max element found
-            remove(max_val); // Delete node with maximum value
-           
-            // Propagate max value up
-            t->element = max_val;
+
+        // Drop all chunks without running node destructors; the caller
+        // destroys live nodes first if they need it
+        void release();
+
+        size_t size() const { return live; }
+        size_t bytes() const { return chunks.size() * chunk_nodes * sizeof(Slot); }
+
+    private:
+        union Slot {
+            uint32_t next_free;
+            alignas(Node) unsigned char storage[sizeof(Node)];
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        uint32_t free_list = nil;
+        uint32_t used = 0;      // slots ever handed out by bumping
+        size_t live = 0;
+
+        Slot& slot(uint32_t idx) const {
+            return chunks[idx >> chunk_shift][idx & (chunk_nodes - 1)];
         }
+};
+
+template <typename Node>
+template <typename... Args>
+uint32_t NodeArena<Node>::create(Args&&... args) {
+    uint32_t idx;
+
+    if (free_list != nil) {
+        idx = free_list;
+        free_list = slot(idx).next_free;
+    }
+    else {
+        // Every index below nil is taken; nil itself marks "no node"
+        if (used == nil)
+            throw std::length_error("NodeArena: out of 32-bit node indices");
+        if ((used & (chunk_nodes - 1)) == 0)
+            chunks.emplace_back(new Slot[chunk_nodes]);
+        idx = used++;
+    }
+
+    try {
+        ::new (static_cast<void*>(slot(idx).storage)) Node(std::forward<Args>(args)...);
+    } catch (...) {
+        slot(idx).next_free = free_list;
+        free_list = idx;
+        throw;
+    }
+
+    live++;
+    return idx;
+}
+
+template <typename Node>
+void NodeArena<Node>::destroy(uint32_t idx) {
+    (*this)[idx].~Node();
+
+    slot(idx).next_free = free_list;
+    free_list = idx;
+    live--;
+}
+
+template <typename Node>
+void NodeArena<Node>::release() {
+    chunks.clear();
+    chunks.shrink_to_fit();
+    free_list = nil;
+    used = 0;
+    live = 0;
+}
+
+
+/* BST whose nodes live in a NodeArena. Build, query and drop the whole
+ * tree with clear(), which frees the arena chunk by chunk. */
+template <typename T, typename Compare = std::less<T>>
+class ArenaBST
+{
+    public:
+        using Node = ArenaTreeNode<T>;
+        static constexpr uint32_t nil = NodeArena<Node>::nil;
+
+        uint32_t root = nil;
+
+        ArenaBST() = default;
+        explicit ArenaBST(const Compare& comp) : comp(comp) {}
+        ~ArenaBST() { clear(); }
+
+        bool insert(const T& key);
+        bool search(const T& key) const;
+        bool remove(const T& key);
+
+        void clear();
+
+        size_t size() const { return nodes.size(); }
+        size_t memory_bytes() const { return nodes.bytes(); }
+
+        Node& node(uint32_t idx) { return nodes[idx]; }
+        const Node& node(uint32_t idx) const { return nodes[idx]; }
+
+    private:
+        NodeArena<Node> nodes;
+        Compare comp;
+
+        // Same walk as BST::find_link, over child indices
+        uint32_t* find_link(const T& key);
+};
+
+template <typename T, typename Compare>
+uint32_t* ArenaBST<T, Compare>::find_link(const T& key) {
+    uint32_t* link = &root;
+
+    while (*link != nil) {
+        Node& n = nodes[*link];
+
+        if      (comp(key, n.element)) link = &n.left;
+        else if (comp(n.element, key)) link = &n.right;
+        else                      break; // match found
+    }
+
+    return link;
+}
+
+template <typename T, typename Compare>
+bool ArenaBST<T, Compare>::insert(const T& key) {
+    uint32_t* link = find_link(key);
+
+    // Already exists
+    if (*link != nil) return false;
+
+    // Chunks never move, so `link` stays valid across the allocation
+    uint32_t idx = nodes.create(key);
+    *link = idx;
+
+    return true;
+}
+
+template <typename T, typename Compare>
+bool ArenaBST<T, Compare>::search(const T& key) const {
+    uint32_t i = root;
+
+    while (i != nil) {
+        const Node& n = nodes[i];
+
+        if      (comp(key, n.element)) i = n.left;
+        else if (comp(n.element, key)) i = n.right;
+        else                      return true; // match found
+    }
+
+    return false;
+}
+
+template <typename T, typename Compare>
+bool ArenaBST<T, Compare>::remove(const T& key) {
+    uint32_t* link = find_link(key);
+
+    // Not in tree
+    if (*link == nil) return false;
+
+    uint32_t idx = *link;
+    Node& n = nodes[idx];
+
+    // Has at most one child: bypass the node
+    if (n.left == nil || n.right == nil) {
+        *link = (n.left == nil) ? n.right : n.left;
+        nodes.destroy(idx);
 
         return true;
     }
+
+    // Has both children: find max element from left subtree
+    uint32_t* max_link = &n.left;
+    while (nodes[*max_link].right != nil)
+        max_link = &nodes[*max_link].right;
+
+    // Propagate max value up and unlink the max node
+    uint32_t max_idx = *max_link;
+    n.element = std::move(nodes[max_idx].element);
+    *max_link = nodes[max_idx].left;
+    nodes.destroy(max_idx);
+
+    return true;
+}
+
+template <typename T, typename Compare>
+void ArenaBST<T, Compare>::clear() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        std::vector<uint32_t> stack;
+        if (root != nil)
+            stack.push_back(root);
+
+        while (!stack.empty()) {
+            Node& n = nodes[stack.back()];
+            stack.pop_back();
+
+            if (n.left != nil)  stack.push_back(n.left);
+            if (n.right != nil) stack.push_back(n.right);
+            n.~Node();
+        }
+    }
+
+    nodes.release();
+    root = nil;
 }
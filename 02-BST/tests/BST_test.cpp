@@ -2,6 +2,9 @@
 #include <iterator>
 #include <vector>
 #include <random>
+#include <string>
+#include <string_view>
+#include <numeric>
 
 #include "BST.hpp"
 
@@ -105,3 +108,343 @@ TEST_CASE("BST remove test", "[BST]") {
 
 
 }
+
+
+TEST_CASE("BST handles a degenerate sorted chain", "[BST]") {
+
+    const int n = 1 << 14;
+
+    BST<int> bt;
+
+    // Every node hangs off the right of the previous one
+    for (int i = 0; i < n; i++)
+        REQUIRE(bt.insert(i) == true);
+
+    REQUIRE(bt.insert(n - 1) == false);
+    REQUIRE(bt.search(n - 1) == true);
+    REQUIRE(bt.search(n) == false);
+
+    for (int i = 0; i < n; i += 2)
+        REQUIRE(bt.remove(i) == true);
+
+    for (int i = 0; i < n; i++)
+        REQUIRE(bt.search(i) == (i % 2 == 1));
+
+    // Descending keys build a left chain under the remaining root
+    for (int i = -1; i > -n; i--)
+        REQUIRE(bt.insert(i) == true);
+
+    // The remaining root has both children now
+    REQUIRE(bt.remove(1) == true);
+    REQUIRE(bt.root->element == -1);
+
+    bt.clear();
+    REQUIRE(bt.root == nullptr);
+    REQUIRE(bt.search(3) == false);
+}
+
+
+TEST_CASE("BST remove of a node with two children", "[BST]") {
+
+    BST<int> bt;
+
+    /*     5
+     *    / \
+     *   3   9
+     *  / \
+     * 1   4
+     */
+    for (int k : { 5, 3, 9, 1, 4 })
+        bt.insert(k);
+
+    REQUIRE(bt.remove(5) == true);
+    REQUIRE(bt.root->element == 4);
+    REQUIRE(bt.root->left->element == 3);
+    REQUIRE(bt.root->left->left->element == 1);
+    REQUIRE(bt.root->left->right == nullptr);
+
+    REQUIRE(bt.remove(4) == true);
+    REQUIRE(bt.root->element == 3);
+    REQUIRE(bt.root->left->element == 1);
+    REQUIRE(bt.root->right->element == 9);
+}
+
+
+template <typename T, typename Compare>
+void is_BST(const ArenaBST<T, Compare>& t, uint32_t n, std::vector<T>& sorted) {
+    std::vector<uint32_t> stack;
+
+    // In-order walk with an explicit stack
+    while (n != t.nil || !stack.empty()) {
+        while (n != t.nil) {
+            stack.push_back(n);
+            n = t.node(n).left;
+        }
+        n = stack.back();
+        stack.pop_back();
+
+        sorted.push_back(t.node(n).element);
+        n = t.node(n).right;
+    }
+}
+
+TEST_CASE("ArenaBST insert/search/remove test", "[BST]") {
+
+    ArenaBST<int> bt;
+
+    std::vector<int> v;
+    v.resize(10000);
+    std::generate(v.begin(), v.end(), std::rand);
+    std::sort(v.begin(), v.end());
+    auto last = std::unique(v.begin(), v.end());
+    v.erase(last, v.end());
+    std::random_shuffle(v.begin(), v.end());
+
+    for (auto ele: v) {
+        REQUIRE(bt.search(ele) == false);
+        REQUIRE(bt.insert(ele) == true);
+        REQUIRE(bt.insert(ele) == false);
+        REQUIRE(bt.search(ele) == true);
+    }
+    REQUIRE(bt.size() == v.size());
+
+    auto x = std::vector<int>(v.begin(), v.begin() + v.size() / 2);
+
+    for (auto ele: x) {
+        REQUIRE(bt.remove(ele) == true);
+        REQUIRE(bt.remove(ele) == false);
+    }
+
+    std::vector<int> sorted;
+    is_BST(bt, bt.root, sorted);
+    REQUIRE(std::is_sorted(sorted.begin(), sorted.end()));
+    REQUIRE(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    REQUIRE(sorted.size() == v.size() - x.size());
+    REQUIRE(bt.size() == sorted.size());
+
+    // Freed slots are reused before the arena grows
+    size_t bytes = bt.memory_bytes();
+    for (auto ele: x)
+        bt.insert(ele);
+    REQUIRE(bt.memory_bytes() == bytes);
+
+    bt.clear();
+    REQUIRE(bt.root == bt.nil);
+    REQUIRE(bt.size() == 0);
+    REQUIRE(bt.memory_bytes() == 0);
+    REQUIRE(bt.search(v[0]) == false);
+}
+
+TEST_CASE("ArenaBST with non-trivial elements", "[BST]") {
+
+    ArenaBST<std::string> bt;
+
+    for (int i = 0; i < 3000; i++)
+        bt.insert(std::string(40, 'b') + std::to_string(i * 7919 % 3000));
+
+    for (int i = 0; i < 3000; i += 2)
+        REQUIRE(bt.remove(std::string(40, 'b') + std::to_string(i)) == true);
+
+    REQUIRE(bt.size() == 1500);
+    REQUIRE(bt.search(std::string(40, 'b') + "1") == true);
+    REQUIRE(bt.search(std::string(40, 'b') + "2") == false);
+}
+
+
+template <typename T>
+int depth(const std::unique_ptr<TreeNode<T>>& t) {
+    return t ? std::max(depth(t->left), depth(t->right)) + 1 : 0;
+}
+
+TEST_CASE("ArenaBST with a custom Compare", "[BST]") {
+
+    ArenaBST<int, std::greater<int>> bt;
+    std::vector<int> v(500);
+    std::iota(v.begin(), v.end(), 0);
+    std::shuffle(v.begin(), v.end(), std::mt19937(5));
+
+    for (auto ele: v)
+        REQUIRE(bt.insert(ele) == true);
+    REQUIRE(bt.search(250) == true);
+    REQUIRE(bt.remove(250) == true);
+    REQUIRE(bt.search(250) == false);
+
+    // In-order is descending under std::greater
+    std::vector<int> sorted;
+    is_BST(bt, bt.root, sorted);
+    REQUIRE(sorted.size() == 499);
+    REQUIRE(std::is_sorted(sorted.rbegin(), sorted.rend()));
+}
+
+TEST_CASE("BST from_sorted builds a balanced tree", "[BST]") {
+
+    for (int n : { 0, 1, 2, 3, 1000, 1 << 15, (1 << 16) - 1 }) {
+        std::vector<int> v(n);
+        std::iota(v.begin(), v.end(), 0);
+
+        BST<int> bt, pbt;
+        bt.insert(-5);
+
+        bt.from_sorted(v.begin(), v.end());
+        pbt.from_sorted_parallel(v.begin(), v.end(), 4);
+
+        for (BST<int>* t : { &bt, &pbt }) {
+            std::vector<int> sorted;
+            is_BST(t->root, sorted);
+            REQUIRE(sorted == v);
+
+            // floor(log2(n)) + 1 levels
+            int levels = 0;
+            while ((1 << levels) <= n) levels++;
+            REQUIRE(depth(t->root) == levels);
+        }
+
+        REQUIRE(bt.search(-5) == false);
+        if (n > 0) {
+            REQUIRE(bt.insert(n) == true);
+            REQUIRE(pbt.remove(n / 2) == true);
+            REQUIRE(pbt.search(n / 2) == false);
+        }
+    }
+}
+
+
+TEST_CASE("BST freeze test", "[BST]") {
+
+    BST<int> bt;
+
+    std::vector<int> v;
+    v.resize(5000);
+    std::generate(v.begin(), v.end(), [] { return std::rand() % 50000; });
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    std::random_shuffle(v.begin(), v.end());
+
+    for (auto ele: v)
+        bt.insert(ele);
+    std::sort(v.begin(), v.end());
+
+    EytzingerSet<int> frozen = bt.freeze();
+    REQUIRE(frozen.size() == v.size());
+    REQUIRE(std::equal(frozen.begin(), frozen.end(), v.begin(), v.end()));
+
+    for (int probe = -1; probe <= 50001; probe += 7) {
+        REQUIRE(frozen.contains(probe) == bt.search(probe));
+
+        auto lb = std::lower_bound(v.begin(), v.end(), probe);
+        auto it = frozen.lower_bound(probe);
+        REQUIRE((it == frozen.end()) == (lb == v.end()));
+        if (lb != v.end()) REQUIRE(*it == *lb);
+    }
+
+    // A sorted chain freezes without recursion as well
+    BST<int> chain;
+    for (int i = 0; i < 1 << 12; i++)
+        chain.insert(i);
+    EytzingerSet<int> frozen_chain = chain.freeze();
+    REQUIRE(*--frozen_chain.end() == (1 << 12) - 1);
+    REQUIRE(frozen_chain.contains(77) == true);
+    REQUIRE(frozen_chain.contains(1 << 12) == false);
+
+    BST<int> empty;
+    REQUIRE(empty.freeze().begin() == empty.freeze().end());
+}
+
+
+TEST_CASE("BST ordered iteration and range test", "[BST]") {
+
+    BST<int> bt;
+    REQUIRE(bt.begin() == bt.end());
+    REQUIRE(bt.lower_bound(3) == bt.end());
+
+    std::vector<int> v;
+    v.resize(5000);
+    std::generate(v.begin(), v.end(), [] { return std::rand() % 50000; });
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    std::random_shuffle(v.begin(), v.end());
+
+    for (auto ele: v)
+        bt.insert(ele);
+    std::sort(v.begin(), v.end());
+
+    REQUIRE(std::vector<int>(bt.begin(), bt.end()) == v);
+
+    for (int probe = -1; probe <= 50001; probe += 13) {
+        auto lb = std::lower_bound(v.begin(), v.end(), probe);
+        auto it = bt.lower_bound(probe);
+        REQUIRE((it == bt.end()) == (lb == v.end()));
+        if (lb != v.end()) REQUIRE(*it == *lb);
+
+        auto ub = std::upper_bound(v.begin(), v.end(), probe);
+        it = bt.upper_bound(probe);
+        REQUIRE((it == bt.end()) == (ub == v.end()));
+        if (ub != v.end()) REQUIRE(*it == *ub);
+    }
+
+    for (int i = 0; i < 200; i++) {
+        int lo = std::rand() % 50000;
+        int hi = lo + std::rand() % 3000;
+
+        std::vector<int> got;
+        bt.for_each_in_range(lo, hi, [&](int k) { got.push_back(k); });
+        REQUIRE(got == std::vector<int>(std::lower_bound(v.begin(), v.end(), lo),
+                                        std::lower_bound(v.begin(), v.end(), hi)));
+    }
+
+    // Empty and inverted ranges visit nothing
+    size_t visits = 0;
+    bt.for_each_in_range(v[10], v[10], [&](int) { visits++; });
+    bt.for_each_in_range(v[20], v[10], [&](int) { visits++; });
+    REQUIRE(visits == 0);
+
+    // A degenerate chain is walked without recursion
+    BST<int> chain;
+    for (int i = 0; i < 1 << 12; i++)
+        chain.insert(i);
+    REQUIRE(std::distance(chain.begin(), chain.end()) == 1 << 12);
+    REQUIRE(*chain.lower_bound(4000) == 4000);
+}
+
+TEST_CASE("BST heterogeneous lookup and custom Compare", "[BST]") {
+
+    // std::less<> is transparent, so string_view and C strings are
+    // compared against the stored std::string directly
+    BST<std::string, std::less<>> bt;
+    for (int i = 0; i < 1000; i++)
+        REQUIRE(bt.insert("key" + std::to_string(i)) == true);
+
+    std::string_view sv = "key42";
+    REQUIRE(bt.search(sv) == true);
+    REQUIRE(bt.search("key999") == true);
+    REQUIRE(bt.search("key1000") == false);
+    REQUIRE(*bt.find(sv) == "key42");
+    REQUIRE(bt.find("nope") == bt.end());
+    REQUIRE(*bt.lower_bound("key5") == "key5");
+    REQUIRE(*bt.upper_bound("key5") == "key50");
+
+    REQUIRE(bt.remove(sv) == true);
+    REQUIRE(bt.remove(sv) == false);
+    REQUIRE(bt.search(std::string("key42")) == false);
+    REQUIRE(bt.find(sv) == bt.end());
+
+    // A reversed order is honoured by every query
+    BST<int, std::greater<int>> rev;
+    for (int i = 0; i < 100; i++)
+        rev.insert(i);
+    REQUIRE(*rev.begin() == 99);
+    REQUIRE(*rev.lower_bound(50) == 50);
+    REQUIRE(*rev.upper_bound(50) == 49);
+    REQUIRE(*rev.find(7) == 7);
+    REQUIRE(rev.remove(7) == true);
+    REQUIRE(rev.search(7) == false);
+
+    std::vector<int> got;
+    rev.for_each_in_range(20, 15, [&](int k) { got.push_back(k); });
+    REQUIRE(got == std::vector<int>{ 20, 19, 18, 17, 16 });
+
+    EytzingerSet<int, std::greater<int>> frozen = rev.freeze();
+    REQUIRE(*frozen.begin() == 99);
+    REQUIRE(frozen.contains(50) == true);
+    REQUIRE(frozen.contains(7) == false);
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+/* Every allocation in the program goes through here, so the difference
+   in `heap_bytes` around a build is what the tree asked the heap for.
+   The hooks are kept out of line: once a delete is inlined, GCC sees
+   free() applied to the result of a new-expression and cannot tell
+   that this operator new is the malloc that pairs with it. */
+static size_t heap_bytes = 0;
+static size_t heap_allocs = 0;
+
+__attribute__((noinline)) void* operator new(size_t n) {
+    heap_bytes += n;
+    heap_allocs++;
+    if (void* p = std::malloc(n))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template <typename Tree>
+static void run(const char* name, size_t node_size,
+                const std::vector<int>& keys, const std::vector<int>& probes) {
+    Tree* tree = new Tree;
+    size_t bytes0 = heap_bytes, allocs0 = heap_allocs;
+
+    double build_ms = elapsed_ms([&] {
+        for (int k : keys)
+            tree->insert(k);
+    });
+    size_t bytes = heap_bytes - bytes0, allocs = heap_allocs - allocs0;
+
+    size_t found = 0;
+    double lookup_ms = elapsed_ms([&] {
+        for (int k : probes)
+            found += tree->search(k);
+    });
+
+    double drop_ms = elapsed_ms([&] { delete tree; });
+
+    std::printf("%-10s %6zu B %9.1f MiB %10zu %10.1f %9.1f %10.1f %9zu\n",
+                name, node_size, bytes / 1048576.0, allocs, build_ms,
+                lookup_ms * 1e6 / probes.size(), drop_ms, found);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 22;
+
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::vector<int> probes(n);
+    for (auto& p : probes)
+        p = rng() % (2 * n);
+
+    std::printf("%-10s %8s %13s %10s %10s %9s %10s %9s\n",
+                "tree", "node", "heap", "allocs", "build ms", "ns/find", "drop ms", "found");
+
+    run<AVLTree<int>>("AVLTree", sizeof(TreeNode<int>), keys, probes);
+    run<ArenaAVLTree<int>>("ArenaAVL", sizeof(ArenaTreeNode<int>), keys, probes);
+
+    return 0;
+}
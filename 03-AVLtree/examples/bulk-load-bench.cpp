@@ -0,0 +1,63 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/* Build an AVLTree from `keys` with `build`, then check a few keys so the
+   tree cannot be optimized away */
+template <typename F>
+static void run(const char* name, const std::vector<int>& keys, F&& build) {
+    auto tree = std::make_unique<AVLTree<int>>();
+
+    double ms = elapsed_ms([&] { build(*tree); });
+
+    size_t found = 0;
+    for (size_t i = 0; i < keys.size(); i += 4099)
+        found += tree->search(keys[i]);
+
+    std::printf("%-16s %10.1f %8d %8zu\n", name, ms, tree->get_height(tree->root), found);
+
+    // The destructor frees nodes recursively; keep it out of the timing
+    tree.reset();
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 22;
+    unsigned threads = std::thread::hardware_concurrency();
+
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+
+    std::printf("%zu sorted keys, %u hardware threads\n\n", n, threads);
+    std::printf("%-16s %10s %8s %8s\n", "method", "ms", "height", "found");
+
+    run("insert", keys, [&](AVLTree<int>& t) {
+        for (int k : keys)
+            t.insert(k);
+    });
+    run("from_sorted", keys, [&](AVLTree<int>& t) {
+        t.from_sorted(keys.begin(), keys.end());
+    });
+    for (unsigned th : { 2u, 4u, 8u }) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "parallel x%u", th);
+        run(name, keys, [&](AVLTree<int>& t) {
+            t.from_sorted_parallel(keys.begin(), keys.end(), th);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+/* Counts what the trees ask the heap for; see 02-BST/examples/arena-bench */
+static size_t heap_bytes = 0;
+
+void* operator new(size_t n) {
+    heap_bytes += n;
+    if (void* p = std::malloc(n))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+template <typename F>
+static double mops(size_t n, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return n / std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+template <typename Tree, typename K>
+static void run(const char* name, size_t node_size, const std::vector<K>& keys) {
+    auto tree = std::make_unique<Tree>();
+    size_t n = keys.size();
+    size_t found = 0;
+
+    size_t before = heap_bytes;
+    double ins = mops(n, [&] { for (K k : keys) tree->insert(k); });
+    double per_key = (double)(heap_bytes - before) / n;
+
+    double find = mops(n, [&] { for (K k : keys) found += tree->search(k); });
+    double rem = mops(n / 2, [&] {
+        for (size_t i = 0; i < n / 2; i++) tree->remove(keys[i]);
+    });
+
+    std::printf("%-20s %6zu B %9.1f B %10.2f %10.2f %10.2f %9zu\n",
+                name, node_size, per_key, ins, find, rem, found);
+}
+
+template <typename K>
+static void run_key(const char* key_name, size_t n) {
+    std::vector<K> keys(n);
+    std::iota(keys.begin(), keys.end(), K(0));
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "AVLTree<%s>", key_name);
+    run<AVLTree<K>>(name, sizeof(TreeNode<K>), keys);
+    std::snprintf(name, sizeof(name), "Compact<%s>", key_name);
+    run<CompactAVLTree<K>>(name, sizeof(CompactTreeNode<K>), keys);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    std::printf("%zu shuffled keys, Mops/s\n\n", n);
+    std::printf("%-20s %8s %11s %10s %10s %10s %9s\n",
+                "tree", "node", "heap/key", "insert", "search", "remove", "found");
+
+    run_key<int>("int", n);
+    run_key<int64_t>("int64_t", n);
+
+    return 0;
+}
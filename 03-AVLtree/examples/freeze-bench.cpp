@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+template <typename F>
+static double ns_per_op(size_t ops, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+/* usage: freeze-bench [max keys]
+ *
+ * Sizes go from 1K up by 10x to `max keys` (10M by default). 100M works
+ * too but the pointer-based tree alone then needs about 3 GiB. */
+int main(int argc, char** argv) {
+    size_t max_n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    const size_t probes_n = 1 << 20;
+
+    std::mt19937 rng(42);
+
+    std::printf("%10s %12s %12s %12s %10s\n",
+                "keys", "AVL ns", "frozen ns", "sorted ns", "speedup");
+
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        std::vector<int> keys(n);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), rng);
+
+        auto tree = std::make_unique<AVLTree<int>>();
+        for (int k : keys)
+            tree->insert(2 * k);
+
+        EytzingerSet<int> frozen = tree->freeze();
+        std::vector<int> sorted(frozen.begin(), frozen.end());
+
+        // Half of the probes miss
+        std::vector<int> probes(probes_n);
+        for (auto& p : probes)
+            p = rng() % (2 * n);
+
+        size_t hits[3] = {};
+        double avl = ns_per_op(probes_n, [&] {
+            for (int p : probes) hits[0] += tree->search(p);
+        });
+        double eyt = ns_per_op(probes_n, [&] {
+            for (int p : probes) hits[1] += frozen.contains(p);
+        });
+        double bin = ns_per_op(probes_n, [&] {
+            for (int p : probes) hits[2] += std::binary_search(sorted.begin(), sorted.end(), p);
+        });
+
+        if (hits[0] != hits[1] || hits[1] != hits[2]) {
+            std::printf("result mismatch at %zu keys\n", n);
+            return 1;
+        }
+
+        std::printf("%10zu %12.1f %12.1f %12.1f %9.1fx\n", n, avl, eyt, bin, avl / eyt);
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+/* Every allocation in the program goes through here, so the change in
+   `heap_allocs` across a lookup loop is the temporaries it built. */
+static size_t heap_allocs = 0;
+
+void* operator new(size_t n) {
+    heap_allocs++;
+    if (void* p = std::malloc(n))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+template <typename F>
+static void run(const char* name, size_t probes, F&& f) {
+    size_t allocs0 = heap_allocs;
+    auto start = std::chrono::steady_clock::now();
+    size_t hits = f();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / probes;
+
+    std::printf("%-34s %10.1f %14.2f %8zu\n", name, ns,
+                (double)(heap_allocs - allocs0) / probes, hits);
+}
+
+// Longer than the small-string buffer, so a std::string copy allocates
+static std::string make_key(unsigned i) {
+    char buf[48];
+    std::snprintf(buf, sizeof buf, "tenant/0042/user/%010u/profile", i);
+    return buf;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 18;
+    size_t probes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1 << 20;
+
+    std::mt19937 rng(42);
+    auto plain = std::make_unique<AVLTree<std::string>>();
+    auto transparent = std::make_unique<AVLTree<std::string, std::less<>>>();
+    for (unsigned i = 0; i < n; i++) {
+        plain->insert(make_key(2 * i));
+        transparent->insert(make_key(2 * i));
+    }
+
+    // Probe text lives in one buffer, as it would in a parsed request;
+    // about half of the probes hit
+    std::vector<std::string> text(probes);
+    for (auto& t : text)
+        t = make_key(rng() % (2 * n));
+    std::vector<std::string_view> views(text.begin(), text.end());
+
+    std::printf("%zu keys, %zu probes\n\n%-34s %10s %14s %8s\n", n, probes,
+                "lookup", "ns/probe", "allocs/probe", "hits");
+
+    run("std::less<T>, string temporary", probes, [&] {
+        size_t hits = 0;
+        for (std::string_view v : views)
+            hits += plain->search(std::string(v));
+        return hits;
+    });
+    run("std::less<>, string temporary", probes, [&] {
+        size_t hits = 0;
+        for (std::string_view v : views)
+            hits += transparent->search(std::string(v));
+        return hits;
+    });
+    run("std::less<>, string_view", probes, [&] {
+        size_t hits = 0;
+        for (std::string_view v : views)
+            hits += transparent->search(v);
+        return hits;
+    });
+    run("std::less<>, find(string_view)", probes, [&] {
+        size_t hits = 0;
+        for (std::string_view v : views)
+            hits += transparent->find(v) != transparent->end();
+        return hits;
+    });
+
+    return 0;
+}
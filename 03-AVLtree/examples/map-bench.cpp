@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+// A value big enough that std::map nodes span two cache lines
+struct Payload
+{
+    std::array<int64_t, 8> fields{};
+
+    Payload() = default;
+    explicit Payload(int64_t x) { fields.fill(x); }
+};
+
+template <typename F>
+static double ns_per_op(size_t ops, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::vector<int> probes(n);
+    for (auto& p : probes)
+        p = keys[rng() % n];
+
+    auto* avl = new AVLMap<int, Payload>;
+    auto* map = new std::map<int, Payload>;
+    int64_t sums[2] = {};
+    double t[2][5];
+
+    t[0][0] = ns_per_op(n, [&] { for (int k : keys) avl->try_emplace(k, k); });
+    t[1][0] = ns_per_op(n, [&] { for (int k : keys) map->try_emplace(k, k); });
+
+    t[0][1] = ns_per_op(n, [&] { for (int k : probes) sums[0] += avl->find(k)->fields[0]; });
+    t[1][1] = ns_per_op(n, [&] { for (int k : probes) sums[1] += map->find(k)->second.fields[0]; });
+
+    t[0][2] = ns_per_op(n, [&] {
+        for (int k : probes) avl->update(k, [](Payload& p) { p.fields[1]++; });
+    });
+    t[1][2] = ns_per_op(n, [&] {
+        for (int k : probes) {
+            auto it = map->find(k);
+            if (it != map->end()) it->second.fields[1]++;
+        }
+    });
+
+    t[0][3] = ns_per_op(n, [&] { for (int k : probes) avl->insert_or_assign(k, Payload(k)); });
+    t[1][3] = ns_per_op(n, [&] { for (int k : probes) map->insert_or_assign(k, Payload(k)); });
+
+    t[0][4] = ns_per_op(n, [&] { for (int k : keys) avl->erase(k); });
+    t[1][4] = ns_per_op(n, [&] { for (int k : keys) map->erase(k); });
+
+    if (sums[0] != sums[1] || !avl->empty() || !map->empty()) {
+        std::printf("result mismatch\n");
+        return 1;
+    }
+
+    const char* ops[] = { "try_emplace", "find", "update", "insert_or_assign", "erase" };
+
+    std::printf("%zu keys, %zu-byte values\n\n%-18s %12s %14s\n", n, sizeof(Payload),
+                "ns/op", "AVLMap", "std::map");
+    for (int i = 0; i < 5; i++)
+        std::printf("%-18s %12.1f %14.1f\n", ops[i], t[0][i], t[1][i]);
+
+    delete avl;
+    delete map;
+
+    return 0;
+}
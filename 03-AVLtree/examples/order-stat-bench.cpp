@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+template <typename F>
+static double elapsed_ns(size_t ops, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+/* The pre-augmentation way: walk the tree in order and count */
+template <typename F>
+static void in_order(TreeNode<int>* n, F&& visit) {
+    std::vector<TreeNode<int>*> stack;
+
+    while (n != nullptr || !stack.empty()) {
+        while (n != nullptr) {
+            stack.push_back(n);
+            n = n->left.get();
+        }
+        n = stack.back();
+        stack.pop_back();
+
+        if (!visit(n->element))
+            return;
+        n = n->right.get();
+    }
+}
+
+static int scan_select(AVLTree<int>& t, size_t k) {
+    int found = -1;
+    in_order(t.root.get(), [&](int x) {
+        if (k-- == 0) { found = x; return false; }
+        return true;
+    });
+    return found;
+}
+
+static size_t scan_rank(AVLTree<int>& t, int key) {
+    size_t r = 0;
+    in_order(t.root.get(), [&](int x) { return x < key && ++r; });
+    return r;
+}
+
+static size_t scan_count_range(AVLTree<int>& t, int lo, int hi) {
+    size_t c = 0;
+    in_order(t.root.get(), [&](int x) {
+        c += (lo <= x && x <= hi);
+        return x <= hi;
+    });
+    return c;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 20;
+    const size_t fast_ops = 1 << 20, scan_ops = 64;
+
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    auto tree = std::make_unique<AVLTree<int>>();
+    for (int k : keys)
+        tree->insert(2 * k);
+
+    std::vector<int> probes(fast_ops);
+    for (auto& p : probes)
+        p = rng() % (2 * n);
+
+    std::printf("%zu keys\n\n%-12s %14s %14s %10s\n", n, "query", "O(log n) ns", "scan ns", "speedup");
+
+    auto report = [](const char* name, double fast, double scan) {
+        std::printf("%-12s %14.1f %14.1f %9.0fx\n", name, fast, scan, scan / fast);
+    };
+
+    size_t sink = 0;
+    double fast, scan;
+
+    fast = elapsed_ns(fast_ops, [&] {
+        for (int p : probes) sink += *tree->select(p % n);
+    });
+    scan = elapsed_ns(scan_ops, [&] {
+        for (size_t i = 0; i < scan_ops; i++) sink += scan_select(*tree, probes[i] % n);
+    });
+    report("select", fast, scan);
+
+    fast = elapsed_ns(fast_ops, [&] {
+        for (int p : probes) sink += tree->rank(p);
+    });
+    scan = elapsed_ns(scan_ops, [&] {
+        for (size_t i = 0; i < scan_ops; i++) sink += scan_rank(*tree, probes[i]);
+    });
+    report("rank", fast, scan);
+
+    fast = elapsed_ns(fast_ops, [&] {
+        for (int p : probes) sink += tree->count_range(p, p + (int)n / 10);
+    });
+    scan = elapsed_ns(scan_ops, [&] {
+        for (size_t i = 0; i < scan_ops; i++)
+            sink += scan_count_range(*tree, probes[i], probes[i] + (int)n / 10);
+    });
+    report("count_range", fast, scan);
+
+    std::printf("\n(checksum %zu)\n", sink);
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+template <typename F>
+static double ns_per_query(size_t queries, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / queries;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    auto tree = std::make_unique<AVLTree<int>>();
+    std::set<int> set;
+    for (int k : keys) {
+        tree->insert(k);
+        set.insert(k);
+    }
+
+    std::printf("%zu keys\n\n%-8s %10s %16s %14s %14s\n", n, "range", "keys/query",
+                "for_each ns", "iterator ns", "std::set ns");
+
+    for (size_t width : { (size_t)16, (size_t)1024, n / 10 }) {
+        size_t queries = std::max<size_t>(8, (1 << 22) / (width + 64));
+
+        std::vector<int> lows(queries);
+        for (auto& lo : lows)
+            lo = rng() % (n - width);
+
+        long sums[3] = {};
+
+        double f = ns_per_query(queries, [&] {
+            for (int lo : lows)
+                tree->for_each_in_range(lo, lo + (int)width, [&](int k) { sums[0] += k; });
+        });
+        double it = ns_per_query(queries, [&] {
+            for (int lo : lows)
+                for (auto i = tree->lower_bound(lo), e = tree->end(); i != e && *i < lo + (int)width; ++i)
+                    sums[1] += *i;
+        });
+        double st = ns_per_query(queries, [&] {
+            for (int lo : lows)
+                for (auto i = set.lower_bound(lo), e = set.lower_bound(lo + (int)width); i != e; ++i)
+                    sums[2] += *i;
+        });
+
+        if (sums[0] != sums[1] || sums[1] != sums[2]) {
+            std::printf("result mismatch\n");
+            return 1;
+        }
+
+        std::printf("%-8s %10zu %16.1f %14.1f %14.1f\n",
+                    width == 16 ? "narrow" : width == 1024 ? "medium" : "wide",
+                    width, f, it, st);
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AVLTree.hpp"
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static std::unique_ptr<AVLTree<int>> build(const std::vector<int>& sorted) {
+    auto t = std::make_unique<AVLTree<int>>();
+    t->from_sorted(sorted.begin(), sorted.end());
+    return t;
+}
+
+/* Times one operation three ways on fresh copies of the inputs: the
+   element-wise loop, and the join-based version on 1 and on `threads`
+   threads. Tree construction and teardown are not timed. */
+template <typename Loop, typename Bulk>
+static void run(const char* name, const std::vector<int>& a, const std::vector<int>& b,
+                unsigned threads, Loop&& loop, Bulk&& bulk) {
+    double ms[3];
+    int size[3];
+
+    for (int i = 0; i < 3; i++) {
+        auto ta = build(a);
+        auto tb = build(b);
+
+        if (i == 0) ms[i] = elapsed_ms([&] { loop(*ta, *tb); });
+        else        ms[i] = elapsed_ms([&] { bulk(*ta, *tb, i == 1 ? 1 : threads); });
+
+        size[i] = ta->get_size(ta->root);
+    }
+
+    if (size[0] != size[1] || size[1] != size[2]) {
+        std::printf("%s: result sizes differ\n", name);
+        std::exit(1);
+    }
+
+    std::printf("%-12s %10zu %12.1f %12.1f %12.1f %9.1fx %9.1fx\n", name, a.size(),
+                ms[0], ms[1], ms[2], ms[0] / ms[1], ms[0] / ms[2]);
+}
+
+/* usage: set-ops-bench [keys per tree...]
+ *
+ * Each size n pairs the multiples of 2 below 2n with the multiples of 3
+ * below 3n; a third of either set is in the other. Defaults to 1M and
+ * 4M; 50M works given about 10 GiB of memory. */
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+        sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    if (sizes.empty())
+        sizes = { 1000000, 4000000 };
+
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 2u);
+
+    std::printf("%u threads for the parallel column\n\n", threads);
+    std::printf("%-12s %10s %12s %12s %12s %10s %10s\n", "operation", "keys",
+                "loop ms", "join x1 ms", "join xN ms", "speedup", "speedup N");
+
+    for (size_t n : sizes) {
+        std::vector<int> a(n), b(n);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = 2 * (int)i;
+            b[i] = 3 * (int)i;
+        }
+
+        run("union", a, b, threads,
+            [&](AVLTree<int>& ta, AVLTree<int>&) {
+                for (int k : b) ta.insert(k);
+            },
+            [](AVLTree<int>& ta, AVLTree<int>& tb, unsigned th) {
+                ta.union_with(std::move(tb), th);
+            });
+
+        run("intersect", a, b, threads,
+            [&](AVLTree<int>& ta, AVLTree<int>& tb) {
+                for (int k : a)
+                    if (!tb.search(k)) ta.remove(k);
+            },
+            [](AVLTree<int>& ta, AVLTree<int>& tb, unsigned th) {
+                ta.intersect_with(std::move(tb), th);
+            });
+
+        run("difference", a, b, threads,
+            [&](AVLTree<int>& ta, AVLTree<int>&) {
+                for (int k : b) ta.remove(k);
+            },
+            [](AVLTree<int>& ta, AVLTree<int>& tb, unsigned th) {
+                ta.difference_with(std::move(tb), th);
+            });
+    }
+
+    return 0;
+}
@@ -1,6 +1,18 @@
 #include <iostream>
 #include <optional>
 #include <memory>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <iterator>
+#include <cstddef>
+#include <tuple>
+#include <functional>
+#include <utility>
 
 template <typename T>
 class TreeNode
@@ -11,33 +23,307 @@ class TreeNode
         std::unique_ptr<TreeNode<T>> right;
 
         int height;
+        int size;   // number of nodes in this subtree
 
         TreeNode<T>(const T& e)
-            :element{e}, left{nullptr}, right{nullptr}, height{0} {}
+            :element{e}, left{nullptr}, right{nullptr}, height{0}, size{1} {}
 
         ~TreeNode() {}
 
 };
 
 
-template <typename T>
+/* Immutable sorted set in Eytzinger order, built by AVLTree::freeze().
+ * Kept in sync with EytzingerSet in 02-BST/include/BST.hpp, which
+ * documents the layout. */
+template <typename T, typename Compare = std::less<T>>
+class EytzingerSet
+{
+    public:
+        class const_iterator;
+
+        EytzingerSet() = default;
+
+        // The keys must be strictly increasing under `comp`
+        explicit EytzingerSet(std::vector<T> sorted, const Compare& comp = Compare());
+
+        template <typename InputIt>
+        EytzingerSet(InputIt first, InputIt last, const Compare& comp = Compare())
+            : EytzingerSet(std::vector<T>(first, last), comp) {}
+
+        size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+
+        const_iterator begin() const { return const_iterator(this, leftmost(1)); }
+        const_iterator end() const { return const_iterator(this, 0); }
+
+        bool contains(const T& key) const;
+        const_iterator lower_bound(const T& key) const;   // first element >= key
+        const_iterator upper_bound(const T& key) const;   // first element > key
+
+    private:
+        std::vector<T> slots;   // slots[0] is unused
+        size_t n = 0;
+        Compare comp;
+
+        size_t leftmost(size_t k) const;
+        size_t successor(size_t k) const;
+        size_t predecessor(size_t k) const;
+
+        template <typename Less>
+        size_t descend(Less less) const;
+};
+
+/* Bidirectional iterator in key order. Stepping moves between Eytzinger
+ * slots with shifts; slot 0 stands for end(). */
+template <typename T, typename Compare>
+class EytzingerSet<T, Compare>::const_iterator
+{
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return set->slots[k]; }
+        pointer operator->() const { return &set->slots[k]; }
+
+        const_iterator& operator++() { k = set->successor(k); return *this; }
+        const_iterator& operator--() { k = set->predecessor(k); return *this; }
+        const_iterator operator++(int) { auto t = *this; ++*this; return t; }
+        const_iterator operator--(int) { auto t = *this; --*this; return t; }
+
+        bool operator==(const const_iterator& o) const { return k == o.k; }
+        bool operator!=(const const_iterator& o) const { return k != o.k; }
+
+    private:
+        friend class EytzingerSet<T, Compare>;
+
+        const EytzingerSet<T, Compare>* set = nullptr;
+        size_t k = 0;
+
+        const_iterator(const EytzingerSet<T, Compare>* s, size_t k) : set(s), k(k) {}
+};
+
+template <typename T, typename Compare>
+EytzingerSet<T, Compare>::EytzingerSet(std::vector<T> sorted, const Compare& comp)
+    : comp(comp) {
+    n = sorted.size();
+    slots.resize(n + 1);
+
+    // Visit the slots in key order and hand out the sorted keys
+    size_t k = leftmost(1);
+    for (auto& key : sorted) {
+        slots[k] = std::move(key);
+        k = successor(k);
+    }
+}
+
+template <typename T, typename Compare>
+size_t EytzingerSet<T, Compare>::leftmost(size_t k) const {
+    if (k > n) return 0;
+
+    while (2 * k <= n)
+        k = 2 * k;
+
+    return k;
+}
+
+template <typename T, typename Compare>
+size_t EytzingerSet<T, Compare>::successor(size_t k) const {
+    if (2 * k + 1 <= n)
+        return leftmost(2 * k + 1);
+
+    // Climb past every ancestor we are the right child of, then one
+    // more; that lands on 0 from the rightmost slot
+    while (k & 1)
+        k >>= 1;
+
+    return k >> 1;
+}
+
+template <typename T, typename Compare>
+size_t EytzingerSet<T, Compare>::predecessor(size_t k) const {
+    // --end() is the largest key
+    if (k == 0) {
+        k = n == 0 ? 0 : 1;
+        while (2 * k + 1 <= n)
+            k = 2 * k + 1;
+        return k;
+    }
+
+    if (2 * k <= n) {
+        k = 2 * k;
+        while (2 * k + 1 <= n)
+            k = 2 * k + 1;
+        return k;
+    }
+
+    while (k > 1 && !(k & 1))
+        k >>= 1;
+
+    return k >> 1;
+}
+
+/* Walk down to a leaf, going right whenever `less(slot)`. The last slot
+   where we went left is the first one for which `less` is false. */
+template <typename T, typename Compare>
+template <typename Less>
+size_t EytzingerSet<T, Compare>::descend(Less less) const {
+    // Slots 16k .. 16k+15 hold the descendants four levels down; for
+    // small T they share a cache line or two
+    constexpr size_t prefetch_stride = 16;
+
+    size_t k = 1;
+
+    while (k <= n) {
+#if defined(__GNUC__)
+        if (prefetch_stride * k <= n)
+            __builtin_prefetch(slots.data() + prefetch_stride * k);
+#endif
+        k = 2 * k + (less(slots[k]) ? 1 : 0);
+    }
+
+    // Undo the trailing right turns and the final left turn
+    while (k & 1)
+        k >>= 1;
+
+    return k >> 1;
+}
+
+template <typename T, typename Compare>
+typename EytzingerSet<T, Compare>::const_iterator EytzingerSet<T, Compare>::lower_bound(const T& key) const {
+    return const_iterator(this, descend([&](const T& x) { return comp(x, key); }));
+}
+
+template <typename T, typename Compare>
+typename EytzingerSet<T, Compare>::const_iterator EytzingerSet<T, Compare>::upper_bound(const T& key) const {
+    return const_iterator(this, descend([&](const T& x) { return !comp(key, x); }));
+}
+
+template <typename T, typename Compare>
+bool EytzingerSet<T, Compare>::contains(const T& key) const {
+    size_t k = descend([&](const T& x) { return comp(x, key); });
+
+    return k != 0 && !comp(key, slots[k]);
+}
+
+
+template <typename T, typename Compare = std::less<T>>
 class AVLTree
 {
     public:
         std::unique_ptr<TreeNode<T>> root = nullptr;
 
+        AVLTree() = default;
+        explicit AVLTree(const Compare& comp) : comp(comp) {}
+        AVLTree(AVLTree&&) = default;
+        AVLTree& operator=(AVLTree&&) = default;
         ~AVLTree() = default;
 
         bool insert(const T& key); 
         bool remove(const T& key);
+        bool search(const T& key) const;
+
+        // The stored key equivalent to `key`, or nullptr. Unlike find()
+        // this builds no iterator, so it costs the same as search().
+        const T* lookup(const T& key) const;
+
+        // Lookups by any key type that Compare can order against T,
+        // available only when Compare::is_transparent is defined (as for
+        // std::less<>). Probing a std::string tree with a string_view or
+        // a string literal then builds no temporary std::string.
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        bool remove(const K& key);
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        bool search(const K& key) const;
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const T* lookup(const K& key) const;
+
+        // Remove the key equivalent to `key` and hand it back, in one
+        // descent; std::nullopt if there is none
+        std::optional<T> extract(const T& key);
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        std::optional<T> extract(const K& key);
 
         int get_height(std::unique_ptr<TreeNode<T>>& n) const; 
         int get_balance_factor(std::unique_ptr<TreeNode<T>>& n) const; 
+        int get_size(const std::unique_ptr<TreeNode<T>>& n) const;
+
+        // Order statistics over the subtree sizes, O(log n) each:
+        // the k-th smallest key (0-based), the number of keys less than
+        // `key`, and the number of keys in [lo, hi]
+        std::optional<T> select(size_t k) const;
+        size_t rank(const T& key) const;
+        size_t count_range(const T& lo, const T& hi) const;
+
+        // Immutable, pointer-free copy of the current keys for fast reads
+        EytzingerSet<T, Compare> freeze() const;
+
+        // Ordered traversal. Iterators are invalidated by any insert or
+        // remove.
+        class const_iterator;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator lower_bound(const T& key) const;   // first key >= key
+        const_iterator upper_bound(const T& key) const;   // first key > key
+        const_iterator find(const T& key) const;          // end() if absent
+
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator lower_bound(const K& key) const;
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator upper_bound(const K& key) const;
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator find(const K& key) const;
+
+        // Call f(key) for every key in [lo, hi), in order
+        template <typename F>
+        void for_each_in_range(const T& lo, const T& hi, F&& f) const;
+
+        // Replace the contents with the strictly increasing range
+        // [first, last). Builds a perfectly balanced tree bottom-up in
+        // O(n) and fills in every `height` directly, with no rotations.
+        template <typename RandomIt>
+        void from_sorted(RandomIt first, RandomIt last);
+
+        // from_sorted that builds the two halves of large subtrees on
+        // separate threads, using up to `threads` in total
+        template <typename RandomIt>
+        void from_sorted_parallel(RandomIt first, RandomIt last,
+                                  unsigned threads = std::thread::hardware_concurrency());
+
+        // Every key of `left` must be less than `key` and every key of
+        // `right` greater. Runs in O(|height(left) - height(right)| + 1).
+        static AVLTree join(AVLTree&& left, const T& key, AVLTree&& right);
+
+        // Split `tree` into the keys less than and greater than `key`,
+        // reporting whether `key` itself was present. O(log n).
+        static std::tuple<AVLTree, bool, AVLTree> split(AVLTree&& tree, const T& key);
+
+        // Set operations built from split and join. They consume `other`
+        // and take O(m log(n/m + 1)) work for sizes m <= n. The two
+        // halves of large subproblems run in parallel on up to
+        // `threads` threads in total.
+        void union_with(AVLTree&& other, unsigned threads = std::thread::hardware_concurrency());
+        void intersect_with(AVLTree&& other, unsigned threads = std::thread::hardware_concurrency());
+        void difference_with(AVLTree&& other, unsigned threads = std::thread::hardware_concurrency());
 
 
     private:
+        using Link = std::unique_ptr<TreeNode<T>>;
+
+        Compare comp;
+
         bool insert(std::unique_ptr<TreeNode<T>>& n, const T& key); 
-        bool remove(std::unique_ptr<TreeNode<T>>& n, const T& key);
+        template <typename K>
+        bool remove(std::unique_ptr<TreeNode<T>>& n, const K& key,
+                    std::optional<T>* removed = nullptr);
+        template <typename K>
+        const T* lookup_key(const K& key) const;
         void balance(std::unique_ptr<TreeNode<T>>& n);
 
         void left_rotate(std::unique_ptr<TreeNode<T>>& n);
@@ -47,20 +333,151 @@ class AVLTree
 
         T find_rightmost_key(std::unique_ptr<TreeNode<T>>& n) const;
 
+        void update(TreeNode<T>* n);
+        size_t count_not_greater(const T& key) const;
+
+        static constexpr size_t parallel_cutoff = 1 << 14;
+
+        template <typename GoRight>
+        const_iterator descend(GoRight go_right) const;
+
+        template <typename K>
+        const_iterator lower_bound_of(const K& key) const;
+        template <typename K>
+        const_iterator upper_bound_of(const K& key) const;
+        template <typename K>
+        const_iterator find_of(const K& key) const;
+
+        template <typename RandomIt>
+        static std::unique_ptr<TreeNode<T>> build_sorted(RandomIt first, RandomIt last, unsigned threads);
+
+        Link join_nodes(Link l, Link k, Link r);
+        Link join_right(Link l, Link k, Link r);
+        Link join_left(Link l, Link k, Link r);
+        Link join2(Link l, Link r);
+        std::tuple<Link, bool, Link> split_nodes(Link t, const T& key);
+        Link split_last(Link t, Link& last);
+
+        Link union_nodes(Link a, Link b, unsigned threads);
+        Link intersect_nodes(Link a, Link b, unsigned threads);
+        Link difference_nodes(Link a, Link b, unsigned threads);
+
+        template <typename Op>
+        std::pair<Link, Link> fork_join(Op op, Link l1, Link l2, Link r1, Link r2,
+                                        unsigned threads, bool parallel);
+
 };
 
-template <typename T>
-bool AVLTree<T>::insert(const T& key) {
+template <typename T, typename Compare>
+bool AVLTree<T, Compare>::insert(const T& key) {
     return insert(root, key);
 }
 
-template <typename T>
-bool AVLTree<T>::remove(const T& key) {
+template <typename T, typename Compare>
+bool AVLTree<T, Compare>::remove(const T& key) {
     return remove(root, key);
 }
 
-template <typename T>
-bool AVLTree<T>::insert(std::unique_ptr<TreeNode<T>>& n, const T& key) {
+template <typename T, typename Compare>
+template <typename RandomIt>
+void AVLTree<T, Compare>::from_sorted(RandomIt first, RandomIt last) {
+    root = build_sorted(first, last, 1);
+}
+
+template <typename T, typename Compare>
+template <typename RandomIt>
+void AVLTree<T, Compare>::from_sorted_parallel(RandomIt first, RandomIt last, unsigned threads) {
+    root = build_sorted(first, last, std::max(threads, 1u));
+}
+
+template <typename T, typename Compare>
+template <typename RandomIt>
+std::unique_ptr<TreeNode<T>> AVLTree<T, Compare>::build_sorted(RandomIt first, RandomIt last, unsigned threads) {
+    if (first == last) return nullptr;
+
+    // Splitting at the middle keeps both halves within one element of
+    // each other, so every balance factor ends up in {-1, 0, 1}
+    RandomIt mid = first + (last - first) / 2;
+    auto n = std::make_unique<TreeNode<T>>(*mid);
+
+    if (threads > 1 && (size_t)(last - first) >= parallel_cutoff) {
+        auto left = std::async(std::launch::async, build_sorted<RandomIt>,
+                               first, mid, threads / 2);
+        n->right = build_sorted(mid + 1, last, threads - threads / 2);
+        n->left = left.get();
+    }
+    else {
+        n->left = build_sorted(first, mid, 1);
+        n->right = build_sorted(mid + 1, last, 1);
+    }
+
+    int l_height = n->left == nullptr ? -1 : n->left->height;
+    int r_height = n->right == nullptr ? -1 : n->right->height;
+    n->height = std::max(l_height, r_height) + 1;
+    n->size = (int)(last - first);
+
+    return n;
+}
+
+template <typename T, typename Compare>
+bool AVLTree<T, Compare>::search(const T& key) const {
+    return lookup_key(key) != nullptr;
+}
+
+template <typename T, typename Compare>
+const T* AVLTree<T, Compare>::lookup(const T& key) const {
+    return lookup_key(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+bool AVLTree<T, Compare>::remove(const K& key) {
+    return remove(root, key);
+}
+
+template <typename T, typename Compare>
+std::optional<T> AVLTree<T, Compare>::extract(const T& key) {
+    std::optional<T> removed;
+    remove(root, key, &removed);
+    return removed;
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+std::optional<T> AVLTree<T, Compare>::extract(const K& key) {
+    std::optional<T> removed;
+    remove(root, key, &removed);
+    return removed;
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+bool AVLTree<T, Compare>::search(const K& key) const {
+    return lookup_key(key) != nullptr;
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+const T* AVLTree<T, Compare>::lookup(const K& key) const {
+    return lookup_key(key);
+}
+
+template <typename T, typename Compare>
+template <typename K>
+const T* AVLTree<T, Compare>::lookup_key(const K& key) const {
+    const TreeNode<T>* n = root.get();
+
+    while (n != nullptr) {
+        if      (comp(key, n->element)) n = n->left.get();
+        else if (comp(n->element, key)) n = n->right.get();
+        else                       return &n->element; // match found
+    }
+
+    return nullptr;
+}
+
+template <typename T, typename Compare>
+bool AVLTree<T, Compare>::insert(std::unique_ptr<TreeNode<T>>& n, const T& key) {
     // TODO
     // Is empty tree
     if (n == nullptr) {
@@ -70,10 +487,11 @@ bool AVLTree<T>::insert(std::unique_ptr<TreeNode<T>>& n, const T& key) {
         return true;
     }
 
-    // Extract val
-    T val = n->element;
+    // Compare against the stored key in place; copying it would allocate
+    // at every level for keys like std::string
+    const T& val = n->element;
     
-    if (key < val) {
+    if (comp(key, val)) {
         // Traverse down and insert
         bool insert_success = insert(n->left, key);
        
@@ -82,7 +500,7 @@ bool AVLTree<T>::insert(std::unique_ptr<TreeNode<T>>& n, const T& key) {
 
         return insert_success;
     }
-    else if (key > val) {
+    else if (comp(val, key)) {
         // Traverse down and insert
         bool insert_success = insert(n->right, key);
         
@@ -94,21 +512,27 @@ bool AVLTree<T>::insert(std::unique_ptr<TreeNode<T>>& n, const T& key) {
     else return false; // Already exists
 }
 
-template <typename T>
-bool AVLTree<T>::remove(std::unique_ptr<TreeNode<T>>& n, const T& key) {
+template <typename T, typename Compare>
+template <typename K>
+bool AVLTree<T, Compare>::remove(std::unique_ptr<TreeNode<T>>& n, const K& key,
+                                 std::optional<T>* removed) {
     // TODO
     // Is empty tree
     if (n == nullptr) return false;
 
-    // Extract val
-    T val = n->element;
+    // Stored key, by reference so a heterogeneous probe never copies it.
+    // Only used before `n` is replaced below.
+    const T& val = n->element;
 
     // Return value
     bool remove_success;
 
-    if      (key < val) remove_success = remove(n->left, key);
-    else if (key > val) remove_success = remove(n->right, key);
+    if      (comp(key, val)) remove_success = remove(n->left, key, removed);
+    else if (comp(val, key)) remove_success = remove(n->right, key, removed);
     else {
+        // Hand the key out before the node is dropped or overwritten
+        if (removed != nullptr) removed->emplace(std::move(n->element));
+
         // Is leaf node
         if      (n->left == nullptr && n->right == nullptr) n.reset(nullptr);
         // Has only left child
@@ -118,7 +542,6 @@ bool AVLTree<T>::remove(std::unique_ptr<TreeNode<T>>& n, const T& key) {
         // Has both children
         else {
             // Find max element from left subtree
-            T max_val;
             TreeNode<T>* np = n->left.get(); 
 
             // point np to the last node before max node
@@ -126,11 +549,13 @@ bool AVLTree<T>::remove(std::unique_ptr<TreeNode<T>>& n, const T& key) {
                 np = np->right.get();
             }
 
-            max_val = np->element; // Max element found
-            remove(max_val); // Delete node with maximum value
+            T max_val = np->element; // Max element found
+            // Delete node with maximum value from the left subtree only;
+            // starting over from the root could rotate `n` away
+            remove(n->left, max_val);
            
             // Propagate max value up
-            n->element = max_val;
+            n->element = std::move(max_val);
         }
 
         remove_success = true;
@@ -144,13 +569,248 @@ bool AVLTree<T>::remove(std::unique_ptr<TreeNode<T>>& n, const T& key) {
 }
 
 
-template <typename T>
-int AVLTree<T>::get_height(std::unique_ptr<TreeNode<T>>& n) const {
+template <typename T, typename Compare>
+int AVLTree<T, Compare>::get_height(std::unique_ptr<TreeNode<T>>& n) const {
     return n == nullptr ? -1 : n->height;
 }
 
-template <typename T>
-int AVLTree<T>::get_balance_factor(std::unique_ptr<TreeNode<T>>& n) const {
+template <typename T, typename Compare>
+int AVLTree<T, Compare>::get_size(const std::unique_ptr<TreeNode<T>>& n) const {
+    return n == nullptr ? 0 : n->size;
+}
+
+template <typename T, typename Compare>
+std::optional<T> AVLTree<T, Compare>::select(size_t k) const {
+    const TreeNode<T>* n = root.get();
+
+    while (n != nullptr) {
+        size_t l_size = get_size(n->left);
+
+        if (k < l_size) {
+            n = n->left.get();
+        }
+        else if (k > l_size) {
+            k -= l_size + 1;
+            n = n->right.get();
+        }
+        else return n->element;
+    }
+
+    // k >= size of the tree
+    return std::nullopt;
+}
+
+template <typename T, typename Compare>
+size_t AVLTree<T, Compare>::rank(const T& key) const {
+    const TreeNode<T>* n = root.get();
+    size_t r = 0;
+
+    while (n != nullptr) {
+        if (comp(n->element, key)) {
+            // n and its whole left subtree are smaller than key
+            r += get_size(n->left) + 1;
+            n = n->right.get();
+        }
+        else if (comp(key, n->element)) {
+            n = n->left.get();
+        }
+        else return r + get_size(n->left);
+    }
+
+    return r;
+}
+
+template <typename T, typename Compare>
+size_t AVLTree<T, Compare>::count_not_greater(const T& key) const {
+    const TreeNode<T>* n = root.get();
+    size_t r = 0;
+
+    while (n != nullptr) {
+        if (comp(key, n->element)) {
+            n = n->left.get();
+        }
+        else {
+            r += get_size(n->left) + 1;
+            n = n->right.get();
+        }
+    }
+
+    return r;
+}
+
+template <typename T, typename Compare>
+size_t AVLTree<T, Compare>::count_range(const T& lo, const T& hi) const {
+    if (comp(hi, lo)) return 0;
+
+    return count_not_greater(hi) - rank(lo);
+}
+
+/* In-order iterator over a AVLTree. It keeps the path of ancestors
+ * still to be visited on an explicit stack, top being the current node,
+ * so ++ is O(1) amortized and never recurses. Keys are read-only. */
+template <typename T, typename Compare>
+class AVLTree<T, Compare>::const_iterator
+{
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return path.back()->element; }
+        pointer operator->() const { return &path.back()->element; }
+
+        const_iterator& operator++() {
+            const TreeNode<T>* n = path.back();
+            path.pop_back();
+            push_left(n->right.get());
+            return *this;
+        }
+        const_iterator operator++(int) { auto t = *this; ++*this; return t; }
+
+        bool operator==(const const_iterator& o) const {
+            return path.empty() ? o.path.empty() : (!o.path.empty() && path.back() == o.path.back());
+        }
+        bool operator!=(const const_iterator& o) const { return !(*this == o); }
+
+    private:
+        friend class AVLTree<T, Compare>;
+
+        std::vector<const TreeNode<T>*> path;
+
+        void push_left(const TreeNode<T>* n) {
+            for (; n != nullptr; n = n->left.get())
+                path.push_back(n);
+        }
+};
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::begin() const {
+    const_iterator it;
+    it.push_left(root.get());
+    return it;
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::end() const {
+    return const_iterator();
+}
+
+/* Descend as for a search, stacking exactly the nodes where we turned
+   left: they are the ones still ahead of the first key not going right */
+template <typename T, typename Compare>
+template <typename GoRight>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::descend(GoRight go_right) const {
+    const_iterator it;
+    const TreeNode<T>* n = root.get();
+
+    while (n != nullptr) {
+        if (go_right(n->element)) {
+            n = n->right.get();
+        }
+        else {
+            it.path.push_back(n);
+            n = n->left.get();
+        }
+    }
+
+    return it;
+}
+
+template <typename T, typename Compare>
+template <typename K>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::lower_bound_of(const K& key) const {
+    return descend([&](const T& x) { return comp(x, key); });
+}
+
+template <typename T, typename Compare>
+template <typename K>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::upper_bound_of(const K& key) const {
+    return descend([&](const T& x) { return !comp(key, x); });
+}
+
+template <typename T, typename Compare>
+template <typename K>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::find_of(const K& key) const {
+    const_iterator it = lower_bound_of(key);
+
+    if (it != end() && comp(key, *it))
+        return end();
+
+    return it;
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::lower_bound(const T& key) const {
+    return lower_bound_of(key);
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::upper_bound(const T& key) const {
+    return upper_bound_of(key);
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::find(const T& key) const {
+    return find_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::lower_bound(const K& key) const {
+    return lower_bound_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::upper_bound(const K& key) const {
+    return upper_bound_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::find(const K& key) const {
+    return find_of(key);
+}
+
+template <typename T, typename Compare>
+template <typename F>
+void AVLTree<T, Compare>::for_each_in_range(const T& lo, const T& hi, F&& f) const {
+    // Subtrees entirely below `lo` are never entered, and the walk stops
+    // at the first key >= hi
+    for (auto it = lower_bound(lo), last = end(); it != last && comp(*it, hi); ++it)
+        f(*it);
+}
+
+template <typename T, typename Compare>
+EytzingerSet<T, Compare> AVLTree<T, Compare>::freeze() const {
+    std::vector<T> sorted;
+    sorted.reserve(get_size(root));
+
+    // In-order walk with an explicit stack
+    std::vector<const TreeNode<T>*> stack;
+    const TreeNode<T>* n = root.get();
+
+    while (n != nullptr || !stack.empty()) {
+        while (n != nullptr) {
+            stack.push_back(n);
+            n = n->left.get();
+        }
+        n = stack.back();
+        stack.pop_back();
+
+        sorted.push_back(n->element);
+        n = n->right.get();
+    }
+
+    return EytzingerSet<T, Compare>(std::move(sorted), comp);
+}
+
+template <typename T, typename Compare>
+int AVLTree<T, Compare>::get_balance_factor(std::unique_ptr<TreeNode<T>>& n) const {
     // TODO
     if (n == nullptr) return 0;
 
@@ -161,8 +821,8 @@ int AVLTree<T>::get_balance_factor(std::unique_ptr<TreeNode<T>>& n) const {
 }
 
 
-template <typename T>
-void AVLTree<T>::balance(std::unique_ptr<TreeNode<T>>& n) {
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::balance(std::unique_ptr<TreeNode<T>>& n) {
     // You do not have to use/write balance function if you think it is unnecessary.
     int balance_factor = get_balance_factor(n);
 
@@ -181,14 +841,20 @@ void AVLTree<T>::balance(std::unique_ptr<TreeNode<T>>& n) {
         if (right_right_h < right_left_h) left_right_rotate(n);
     }
 
-    // Set new height
+    // Set new height and size
     // Ref: Data Structures and Algorithm Analysis in C++, pg. 173
+    update(n.get());
+}
+
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::update(TreeNode<T>* n) {
     n->height = std::max(get_height(n->left), get_height(n->right)) + 1;
+    n->size = get_size(n->left) + get_size(n->right) + 1;
 }
 
 
-template <typename T>
-void AVLTree<T>::left_rotate(std::unique_ptr<TreeNode<T>>& n) {
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::left_rotate(std::unique_ptr<TreeNode<T>>& n) {
     // TODO
     std::unique_ptr<TreeNode<T>> m = std::move(n->right);
     n->right= std::move(m->left);
@@ -196,14 +862,14 @@ void AVLTree<T>::left_rotate(std::unique_ptr<TreeNode<T>>& n) {
 
     TreeNode<T>* new_left = m->left.get();
 
-    new_left->height = std::max(get_height(new_left->left), get_height(new_left->right)) + 1;
-    m->height = std::max(get_height(m->left), get_height(m->right)) + 1;
+    update(new_left);
+    update(m.get());
 
     n = std::move(m);
 }
 
-template <typename T>
-void AVLTree<T>::right_rotate(std::unique_ptr<TreeNode<T>>& n) {
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::right_rotate(std::unique_ptr<TreeNode<T>>& n) {
     // TODO
     std::unique_ptr<TreeNode<T>> m = std::move(n->left);
     n->left = std::move(m->right); // OK
@@ -211,27 +877,1107 @@ void AVLTree<T>::right_rotate(std::unique_ptr<TreeNode<T>>& n) {
 
     TreeNode<T>* new_right = m->right.get();
 
-    new_right->height = std::max(get_height(new_right->left), get_height(new_right->right)) + 1;
-    m->height = std::max(get_height(m->left), get_height(m->right)) + 1;
+    update(new_right);
+    update(m.get());
 
     n = std::move(m);
 }
 
-template <typename T>
-void AVLTree<T>::left_right_rotate(std::unique_ptr<TreeNode<T>>& n) {
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::left_right_rotate(std::unique_ptr<TreeNode<T>>& n) {
     // TODO
     right_rotate(n->right);
     left_rotate(n);
 }
 
-template <typename T>
-void AVLTree<T>::right_left_rotate(std::unique_ptr<TreeNode<T>>& n) {
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::right_left_rotate(std::unique_ptr<TreeNode<T>>& n) {
     // TODO
     left_rotate(n->left);
     right_rotate(n);
 }
 
-template <typename T>
-T AVLTree<T>::find_rightmost_key(std::unique_ptr<TreeNode<T>>& n) const { 
+template <typename T, typename Compare>
+T AVLTree<T, Compare>::find_rightmost_key(std::unique_ptr<TreeNode<T>>& n) const { 
     // You do not have to use/write this function if you think it is unnecessary.
 }
+
+
+template <typename T, typename Compare>
+AVLTree<T, Compare> AVLTree<T, Compare>::join(AVLTree&& left, const T& key, AVLTree&& right) {
+    AVLTree<T, Compare> t(left.comp);
+    t.root = t.join_nodes(std::move(left.root), std::make_unique<TreeNode<T>>(key),
+                          std::move(right.root));
+
+    return t;
+}
+
+template <typename T, typename Compare>
+std::tuple<AVLTree<T, Compare>, bool, AVLTree<T, Compare>> AVLTree<T, Compare>::split(AVLTree&& tree, const T& key) {
+    AVLTree<T, Compare> less(tree.comp), greater(tree.comp);
+    bool found;
+
+    std::tie(less.root, found, greater.root) = tree.split_nodes(std::move(tree.root), key);
+
+    return { std::move(less), found, std::move(greater) };
+}
+
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::union_with(AVLTree&& other, unsigned threads) {
+    root = union_nodes(std::move(root), std::move(other.root), std::max(threads, 1u));
+}
+
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::intersect_with(AVLTree&& other, unsigned threads) {
+    root = intersect_nodes(std::move(root), std::move(other.root), std::max(threads, 1u));
+}
+
+template <typename T, typename Compare>
+void AVLTree<T, Compare>::difference_with(AVLTree&& other, unsigned threads) {
+    root = difference_nodes(std::move(root), std::move(other.root), std::max(threads, 1u));
+}
+
+/* Hang `l` and `r` under the single node `k`, rebalancing along the
+   spine of the taller side only. */
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::join_nodes(Link l, Link k, Link r) {
+    if (get_height(l) > get_height(r) + 1) return join_right(std::move(l), std::move(k), std::move(r));
+    if (get_height(r) > get_height(l) + 1) return join_left(std::move(l), std::move(k), std::move(r));
+
+    k->left = std::move(l);
+    k->right = std::move(r);
+    update(k.get());
+
+    return k;
+}
+
+/* `l` is the taller tree: walk down its right spine to the first subtree
+   no more than one level taller than `r`, and attach `k` there */
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::join_right(Link l, Link k, Link r) {
+    if (get_height(l->right) <= get_height(r) + 1) {
+        k->left = std::move(l->right);
+        k->right = std::move(r);
+        update(k.get());
+
+        l->right = std::move(k);
+        if (get_height(l->right) > get_height(l->left) + 1) {
+            right_rotate(l->right);
+            left_rotate(l);
+        }
+        else update(l.get());
+
+        return l;
+    }
+
+    l->right = join_right(std::move(l->right), std::move(k), std::move(r));
+    if (get_height(l->right) > get_height(l->left) + 1) left_rotate(l);
+    else update(l.get());
+
+    return l;
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::join_left(Link l, Link k, Link r) {
+    if (get_height(r->left) <= get_height(l) + 1) {
+        k->left = std::move(l);
+        k->right = std::move(r->left);
+        update(k.get());
+
+        r->left = std::move(k);
+        if (get_height(r->left) > get_height(r->right) + 1) {
+            left_rotate(r->left);
+            right_rotate(r);
+        }
+        else update(r.get());
+
+        return r;
+    }
+
+    r->left = join_left(std::move(l), std::move(k), std::move(r->left));
+    if (get_height(r->left) > get_height(r->right) + 1) right_rotate(r);
+    else update(r.get());
+
+    return r;
+}
+
+/* Join without a middle key: borrow the largest key of `l` */
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::join2(Link l, Link r) {
+    if (l == nullptr) return r;
+
+    Link last;
+    Link rest = split_last(std::move(l), last);
+
+    return join_nodes(std::move(rest), std::move(last), std::move(r));
+}
+
+/* Detach the rightmost node of `t` into `last` and return the rest */
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::split_last(Link t, Link& last) {
+    if (t->right == nullptr) {
+        Link rest = std::move(t->left);
+        last = std::move(t);
+
+        return rest;
+    }
+
+    Link r = split_last(std::move(t->right), last);
+    Link l = std::move(t->left);
+
+    return join_nodes(std::move(l), std::move(t), std::move(r));
+}
+
+template <typename T, typename Compare>
+std::tuple<typename AVLTree<T, Compare>::Link, bool, typename AVLTree<T, Compare>::Link>
+AVLTree<T, Compare>::split_nodes(Link t, const T& key) {
+    if (t == nullptr) return { nullptr, false, nullptr };
+
+    Link l = std::move(t->left);
+    Link r = std::move(t->right);
+
+    if (comp(key, t->element)) {
+        auto [ll, found, lr] = split_nodes(std::move(l), key);
+        return { std::move(ll), found, join_nodes(std::move(lr), std::move(t), std::move(r)) };
+    }
+    if (comp(t->element, key)) {
+        auto [rl, found, rr] = split_nodes(std::move(r), key);
+        return { join_nodes(std::move(l), std::move(t), std::move(rl)), found, std::move(rr) };
+    }
+
+    // Match found; the node itself is dropped
+    return { std::move(l), true, std::move(r) };
+}
+
+/* Run `op` on the left pair and the right pair, the left one on a new
+   thread when `parallel`, splitting the thread budget between them */
+template <typename T, typename Compare>
+template <typename Op>
+std::pair<typename AVLTree<T, Compare>::Link, typename AVLTree<T, Compare>::Link>
+AVLTree<T, Compare>::fork_join(Op op, Link l1, Link l2, Link r1, Link r2, unsigned threads, bool parallel) {
+    if (!parallel) {
+        Link l = (this->*op)(std::move(l1), std::move(l2), 1);
+        Link r = (this->*op)(std::move(r1), std::move(r2), 1);
+
+        return { std::move(l), std::move(r) };
+    }
+
+    auto left = std::async(std::launch::async, op, this, std::move(l1), std::move(l2), threads / 2);
+    Link r = (this->*op)(std::move(r1), std::move(r2), threads - threads / 2);
+
+    return { left.get(), std::move(r) };
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::union_nodes(Link a, Link b, unsigned threads) {
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+
+    bool parallel = threads > 1 && (size_t)(get_size(a) + get_size(b)) >= parallel_cutoff;
+
+    // Split `a` around the root key of `b`, then merge side by side
+    Link l2 = std::move(b->left);
+    Link r2 = std::move(b->right);
+    auto [l1, found, r1] = split_nodes(std::move(a), b->element);
+    (void)found;
+
+    auto [l, r] = fork_join(&AVLTree<T, Compare>::union_nodes, std::move(l1), std::move(l2),
+                            std::move(r1), std::move(r2), threads, parallel);
+
+    return join_nodes(std::move(l), std::move(b), std::move(r));
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::intersect_nodes(Link a, Link b, unsigned threads) {
+    if (a == nullptr || b == nullptr) return nullptr;
+
+    bool parallel = threads > 1 && (size_t)(get_size(a) + get_size(b)) >= parallel_cutoff;
+
+    Link l2 = std::move(b->left);
+    Link r2 = std::move(b->right);
+    auto [l1, found, r1] = split_nodes(std::move(a), b->element);
+
+    auto [l, r] = fork_join(&AVLTree<T, Compare>::intersect_nodes, std::move(l1), std::move(l2),
+                            std::move(r1), std::move(r2), threads, parallel);
+
+    // Keep the root key of `b` only if `a` had it too
+    if (found) return join_nodes(std::move(l), std::move(b), std::move(r));
+    return join2(std::move(l), std::move(r));
+}
+
+template <typename T, typename Compare>
+typename AVLTree<T, Compare>::Link AVLTree<T, Compare>::difference_nodes(Link a, Link b, unsigned threads) {
+    if (a == nullptr) return nullptr;
+    if (b == nullptr) return a;
+
+    bool parallel = threads > 1 && (size_t)(get_size(a) + get_size(b)) >= parallel_cutoff;
+
+    Link l2 = std::move(b->left);
+    Link r2 = std::move(b->right);
+    auto [l1, found, r1] = split_nodes(std::move(a), b->element);
+    (void)found;
+
+    auto [l, r] = fork_join(&AVLTree<T, Compare>::difference_nodes, std::move(l1), std::move(l2),
+                            std::move(r1), std::move(r2), threads, parallel);
+
+    return join2(std::move(l), std::move(r));
+}
+
+
+/* Ordered map on top of AVLTree. The tree holds only (key, slot) pairs
+ * and each value sits at its slot in one contiguous `values` array, so
+ * a lookup walks small nodes dense in keys and touches the value only
+ * once the key is found. Slots freed by erase are reused by later
+ * inserts. V must be default constructible and move assignable: erase
+ * resets the slot to V() to release whatever the value held. */
+template <typename K, typename V, typename Compare = std::less<K>>
+class AVLMap
+{
+    public:
+        AVLMap() = default;
+        explicit AVLMap(const Compare& comp) : index(EntryLess{comp}) {}
+
+        size_t size() const { return (size_t)index.get_size(index.root); }
+        bool empty() const { return index.root == nullptr; }
+
+        // The value stored under `key`, or nullptr. Pointers to values
+        // stay valid until the next insertion or clear().
+        V* find(const K& key);
+        const V* find(const K& key) const;
+        bool contains(const K& key) const { return index.search(key); }
+
+        // Insert key -> V(args...) unless `key` is already present, in
+        // which case nothing is constructed. Returns the value under
+        // `key` and whether it was inserted.
+        template <typename... Args>
+        std::pair<V*, bool> try_emplace(const K& key, Args&&... args);
+
+        // Insert key -> value, or assign value over the existing one
+        template <typename M>
+        std::pair<V*, bool> insert_or_assign(const K& key, M&& value);
+
+        // Call f(V&) on the value under `key` in place, with a single
+        // descent. Returns false if `key` is absent.
+        template <typename F>
+        bool update(const K& key, F&& f);
+
+        bool erase(const K& key);
+        void clear();
+
+        // Call f(key, value) for every entry in key order
+        template <typename F>
+        void for_each(F&& f) const;
+
+    private:
+        struct Entry
+        {
+            K key;
+            uint32_t slot;
+        };
+
+        // Orders entries by key; transparent so the index can be probed
+        // with a bare K
+        struct EntryLess
+        {
+            using is_transparent = void;
+
+            Compare comp;
+
+            bool operator()(const Entry& a, const Entry& b) const { return comp(a.key, b.key); }
+            bool operator()(const Entry& a, const K& b) const { return comp(a.key, b); }
+            bool operator()(const K& a, const Entry& b) const { return comp(a, b.key); }
+        };
+
+        AVLTree<Entry, EntryLess> index;
+        std::vector<V> values;
+        std::vector<uint32_t> free_slots;
+
+        uint32_t next_slot() const;
+
+        template <typename... Args>
+        V* fill_slot(uint32_t slot, Args&&... args);
+};
+
+template <typename K, typename V, typename Compare>
+V* AVLMap<K, V, Compare>::find(const K& key) {
+    const Entry* e = index.lookup(key);
+
+    return e != nullptr ? &values[e->slot] : nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+const V* AVLMap<K, V, Compare>::find(const K& key) const {
+    const Entry* e = index.lookup(key);
+
+    return e != nullptr ? &values[e->slot] : nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+template <typename... Args>
+std::pair<V*, bool> AVLMap<K, V, Compare>::try_emplace(const K& key, Args&&... args) {
+    // Insert with the slot the value would get; if the key turns out to
+    // be present the index is unchanged and the slot stays free
+    uint32_t slot = next_slot();
+
+    if (!index.insert(Entry{ key, slot }))
+        return { &values[index.lookup(key)->slot], false };
+
+    // The entry must not outlive a value that failed to construct, or
+    // find() would hand out a slot that was never filled
+    try {
+        return { fill_slot(slot, std::forward<Args>(args)...), true };
+    }
+    catch (...) {
+        index.remove(key);
+        throw;
+    }
+}
+
+template <typename K, typename V, typename Compare>
+template <typename M>
+std::pair<V*, bool> AVLMap<K, V, Compare>::insert_or_assign(const K& key, M&& value) {
+    // Assigning over an existing key is the common case; it costs one
+    // descent instead of a failed insert plus a lookup
+    if (V* v = find(key)) {
+        *v = std::forward<M>(value);
+        return { v, false };
+    }
+
+    return try_emplace(key, std::forward<M>(value));
+}
+
+template <typename K, typename V, typename Compare>
+template <typename F>
+bool AVLMap<K, V, Compare>::update(const K& key, F&& f) {
+    V* v = find(key);
+
+    if (v == nullptr) return false;
+
+    f(*v);
+    return true;
+}
+
+template <typename K, typename V, typename Compare>
+bool AVLMap<K, V, Compare>::erase(const K& key) {
+    std::optional<Entry> e = index.extract(key);
+
+    if (!e) return false;
+
+    uint32_t slot = e->slot;
+
+    values[slot] = V();
+    free_slots.push_back(slot);
+
+    return true;
+}
+
+template <typename K, typename V, typename Compare>
+void AVLMap<K, V, Compare>::clear() {
+    index.root.reset();
+    values.clear();
+    free_slots.clear();
+}
+
+template <typename K, typename V, typename Compare>
+template <typename F>
+void AVLMap<K, V, Compare>::for_each(F&& f) const {
+    for (const Entry& e : index)
+        f(e.key, values[e.slot]);
+}
+
+template <typename K, typename V, typename Compare>
+uint32_t AVLMap<K, V, Compare>::next_slot() const {
+    return free_slots.empty() ? (uint32_t)values.size() : free_slots.back();
+}
+
+template <typename K, typename V, typename Compare>
+template <typename... Args>
+V* AVLMap<K, V, Compare>::fill_slot(uint32_t slot, Args&&... args) {
+    // Take the slot off the free list only once the value is in it, so a
+    // throwing constructor leaves the slot free
+    if (slot == values.size()) {
+        values.emplace_back(std::forward<Args>(args)...);
+    }
+    else {
+        values[slot] = V(std::forward<Args>(args)...);
+        free_slots.pop_back();
+    }
+
+    return &values[slot];
+}
+
+/* AVL node for ArenaAVLTree, linked by 32-bit slot indices. */
+template <typename T>
+struct ArenaTreeNode
+{
+    T element;
+    uint32_t left = UINT32_MAX;     // NodeArena::nil
+    uint32_t right = UINT32_MAX;
+    int height = 0;
+
+    ArenaTreeNode(const T& e)
+        :element{e} {}
+};
+
+
+/* Chunked slot storage for nodes addressed by 32-bit indices. Kept in
+ * sync with NodeArena in 02-BST/include/BST.hpp, which documents it. */
+template <typename Node>
+class NodeArena
+{
+    public:
+        static constexpr uint32_t nil = UINT32_MAX;
+        static constexpr uint32_t chunk_shift = 10;
+        static constexpr uint32_t chunk_nodes = 1u << chunk_shift;
+
+        NodeArena() = default;
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+
+        ~NodeArena() { release(); }
+
+        template <typename... Args>
+        uint32_t create(Args&&... args);
+        void destroy(uint32_t idx);
+
+        Node& operator[](uint32_t idx) {
+            return *reinterpret_cast<Node*>(slot(idx).storage);
+        }
+        const Node& operator[](uint32_t idx) const {
+            return *reinterpret_cast<const Node*>(slot(idx).storage);
+        }
+
+        // Drop all chunks without running node destructors; the caller
+        // destroys live nodes first if they need it
+        void release();
+
+        size_t size() const { return live; }
+        size_t bytes() const { return chunks.size() * chunk_nodes * sizeof(Slot); }
+
+    private:
+        union Slot {
+            uint32_t next_free;
+            alignas(Node) unsigned char storage[sizeof(Node)];
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        uint32_t free_list = nil;
+        uint32_t used = 0;      // slots ever handed out by bumping
+        size_t live = 0;
+
+        Slot& slot(uint32_t idx) const {
+            return chunks[idx >> chunk_shift][idx & (chunk_nodes - 1)];
+        }
+};
+
+template <typename Node>
+template <typename... Args>
+uint32_t NodeArena<Node>::create(Args&&... args) {
+    uint32_t idx;
+
+    if (free_list != nil) {
+        idx = free_list;
+        free_list = slot(idx).next_free;
+    }
+    else {
+        // Every index below nil is taken; nil itself marks "no node"
+        if (used == nil)
+            throw std::length_error("NodeArena: out of 32-bit node indices");
+        if ((used & (chunk_nodes - 1)) == 0)
+            chunks.emplace_back(new Slot[chunk_nodes]);
+        idx = used++;
+    }
+
+    try {
+        ::new (static_cast<void*>(slot(idx).storage)) Node(std::forward<Args>(args)...);
+    } catch (...) {
+        slot(idx).next_free = free_list;
+        free_list = idx;
+        throw;
+    }
+
+    live++;
+    return idx;
+}
+
+template <typename Node>
+void NodeArena<Node>::destroy(uint32_t idx) {
+    (*this)[idx].~Node();
+
+    slot(idx).next_free = free_list;
+    free_list = idx;
+    live--;
+}
+
+template <typename Node>
+void NodeArena<Node>::release() {
+    chunks.clear();
+    chunks.shrink_to_fit();
+    free_list = nil;
+    used = 0;
+    live = 0;
+}
+
+
+/* AVLTree with its nodes in a NodeArena. The algorithms follow AVLTree
+ * link for link, with `uint32_t&` child slots in place of
+ * `std::unique_ptr<TreeNode<T>>&`; references into the arena survive
+ * allocation because chunks never move. */
+template <typename T, typename Compare = std::less<T>>
+class ArenaAVLTree
+{
+    public:
+        using Node = ArenaTreeNode<T>;
+        static constexpr uint32_t nil = NodeArena<Node>::nil;
+
+        uint32_t root = nil;
+
+        ArenaAVLTree() = default;
+        explicit ArenaAVLTree(const Compare& comp) : comp(comp) {}
+        ~ArenaAVLTree() { clear(); }
+
+        bool insert(const T& key);
+        bool search(const T& key) const;
+        bool remove(const T& key);
+
+        void clear();
+
+        int get_height(uint32_t n) const;
+        int get_balance_factor(uint32_t n) const;
+
+        size_t size() const { return nodes.size(); }
+        size_t memory_bytes() const { return nodes.bytes(); }
+
+        Node& node(uint32_t idx) { return nodes[idx]; }
+        const Node& node(uint32_t idx) const { return nodes[idx]; }
+
+    private:
+        NodeArena<Node> nodes;
+        Compare comp;
+
+        bool insert(uint32_t& n, const T& key);
+        bool remove(uint32_t& n, const T& key);
+        T remove_rightmost(uint32_t& n);
+        void balance(uint32_t& n);
+        void update_height(uint32_t n);
+
+        void left_rotate(uint32_t& n);
+        void right_rotate(uint32_t& n);
+};
+
+template <typename T, typename Compare>
+bool ArenaAVLTree<T, Compare>::insert(const T& key) {
+    return insert(root, key);
+}
+
+template <typename T, typename Compare>
+bool ArenaAVLTree<T, Compare>::remove(const T& key) {
+    return remove(root, key);
+}
+
+template <typename T, typename Compare>
+bool ArenaAVLTree<T, Compare>::search(const T& key) const {
+    uint32_t i = root;
+
+    while (i != nil) {
+        const Node& n = nodes[i];
+
+        if      (comp(key, n.element)) i = n.left;
+        else if (comp(n.element, key)) i = n.right;
+        else                      return true;
+    }
+
+    return false;
+}
+
+template <typename T, typename Compare>
+void ArenaAVLTree<T, Compare>::clear() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        std::vector<uint32_t> stack;
+        if (root != nil)
+            stack.push_back(root);
+
+        while (!stack.empty()) {
+            Node& n = nodes[stack.back()];
+            stack.pop_back();
+
+            if (n.left != nil)  stack.push_back(n.left);
+            if (n.right != nil) stack.push_back(n.right);
+            n.~Node();
+        }
+    }
+
+    nodes.release();
+    root = nil;
+}
+
+template <typename T, typename Compare>
+bool ArenaAVLTree<T, Compare>::insert(uint32_t& n, const T& key) {
+    // Is empty tree
+    if (n == nil) {
+        n = nodes.create(key);
+        return true;
+    }
+
+    Node& node = nodes[n];
+    bool insert_success;
+
+    if      (comp(key, node.element)) insert_success = insert(node.left, key);
+    else if (comp(node.element, key)) insert_success = insert(node.right, key);
+    else return false; // Already exists
+
+    if (insert_success)
+        balance(n);
+
+    return insert_success;
+}
+
+template <typename T, typename Compare>
+bool ArenaAVLTree<T, Compare>::remove(uint32_t& n, const T& key) {
+    // Is empty tree
+    if (n == nil) return false;
+
+    Node& node = nodes[n];
+    bool remove_success;
+
+    if      (comp(key, node.element)) remove_success = remove(node.left, key);
+    else if (comp(node.element, key)) remove_success = remove(node.right, key);
+    else {
+        // Has at most one child: bypass the node
+        if (node.left == nil || node.right == nil) {
+            uint32_t child = (node.left == nil) ? node.right : node.left;
+            nodes.destroy(n);
+            n = child;
+
+            return true;
+        }
+
+        // Has both children: pull the max element up from the left subtree
+        node.element = remove_rightmost(node.left);
+        remove_success = true;
+    }
+
+    if (remove_success)
+        balance(n);
+
+    return remove_success;
+}
+
+/* Unlink the rightmost node under `n`, rebalancing on the way back up,
+   and return its element. */
+template <typename T, typename Compare>
+T ArenaAVLTree<T, Compare>::remove_rightmost(uint32_t& n) {
+    Node& node = nodes[n];
+
+    if (node.right == nil) {
+        T max_val = std::move(node.element);
+        uint32_t child = node.left;
+        nodes.destroy(n);
+        n = child;
+
+        return max_val;
+    }
+
+    T max_val = remove_rightmost(node.right);
+    balance(n);
+
+    return max_val;
+}
+
+template <typename T, typename Compare>
+int ArenaAVLTree<T, Compare>::get_height(uint32_t n) const {
+    return n == nil ? -1 : nodes[n].height;
+}
+
+template <typename T, typename Compare>
+int ArenaAVLTree<T, Compare>::get_balance_factor(uint32_t n) const {
+    if (n == nil) return 0;
+
+    return get_height(nodes[n].left) - get_height(nodes[n].right);
+}
+
+template <typename T, typename Compare>
+void ArenaAVLTree<T, Compare>::update_height(uint32_t n) {
+    Node& node = nodes[n];
+    node.height = std::max(get_height(node.left), get_height(node.right)) + 1;
+}
+
+template <typename T, typename Compare>
+void ArenaAVLTree<T, Compare>::balance(uint32_t& n) {
+    int balance_factor = get_balance_factor(n);
+
+    if (balance_factor > 1) {
+        if (get_balance_factor(nodes[n].left) < 0)
+            left_rotate(nodes[n].left);
+        right_rotate(n);
+    }
+    else if (balance_factor < -1) {
+        if (get_balance_factor(nodes[n].right) > 0)
+            right_rotate(nodes[n].right);
+        left_rotate(n);
+    }
+    else {
+        update_height(n);
+    }
+}
+
+template <typename T, typename Compare>
+void ArenaAVLTree<T, Compare>::left_rotate(uint32_t& n) {
+    uint32_t m = nodes[n].right;
+    nodes[n].right = nodes[m].left;
+    nodes[m].left = n;
+
+    update_height(n);
+    update_height(m);
+
+    n = m;
+}
+
+template <typename T, typename Compare>
+void ArenaAVLTree<T, Compare>::right_rotate(uint32_t& n) {
+    uint32_t m = nodes[n].left;
+    nodes[n].left = nodes[m].right;
+    nodes[m].right = n;
+
+    update_height(n);
+    update_height(m);
+
+    n = m;
+}
+
+
+/* AVL node without a height field. The balance factor
+ * height(left) - height(right), always -1, 0 or +1, is kept in the two
+ * low bits of the left child pointer, which are zero anyway because
+ * nodes are at least 4-byte aligned. An int or 8-byte key then costs a
+ * 24-byte node. */
+template <typename T>
+class CompactTreeNode
+{
+    public:
+        T element;
+        CompactTreeNode<T>* right = nullptr;
+
+        CompactTreeNode<T>(const T& e)
+            :element{e} {
+            // Checked here, where the node type is complete: the balance
+            // lives in the low bits of pointers to nodes
+            static_assert(alignof(CompactTreeNode<T>) >= 4, "balance bits need 4-byte aligned nodes");
+            set_balance(0);
+        }
+
+        CompactTreeNode<T>* left() const {
+            return reinterpret_cast<CompactTreeNode<T>*>(left_bits & ~balance_mask);
+        }
+        void set_left(CompactTreeNode<T>* n) {
+            left_bits = reinterpret_cast<uintptr_t>(n) | (left_bits & balance_mask);
+        }
+
+        int balance() const { return (int)(left_bits & balance_mask) - 1; }
+        void set_balance(int b) { left_bits = (left_bits & ~balance_mask) | (uintptr_t)(b + 1); }
+
+    private:
+        static constexpr uintptr_t balance_mask = 3;
+
+        uintptr_t left_bits = 0;   // left child | (balance + 1)
+};
+
+
+/* AVLTree with CompactTreeNode nodes. Instead of recomputing heights
+ * from both children at every step, insert and remove carry a single
+ * "height changed" flag back up the search path, adjust the balance
+ * factor of each node on it by one, and stop as soon as a subtree
+ * keeps its height. */
+template <typename T>
+class CompactAVLTree
+{
+    public:
+        using Node = CompactTreeNode<T>;
+
+        Node* root = nullptr;
+
+        CompactAVLTree() = default;
+        CompactAVLTree(const CompactAVLTree&) = delete;
+        CompactAVLTree& operator=(const CompactAVLTree&) = delete;
+
+        ~CompactAVLTree() { clear(); }
+
+        bool insert(const T& key);
+        bool remove(const T& key);
+        bool search(const T& key) const;
+
+        void clear();
+
+        size_t size() const { return count; }
+
+    private:
+        size_t count = 0;
+
+        Node* insert(Node* n, const T& key, bool& inserted, bool& grew);
+        Node* remove(Node* n, const T& key, bool& removed, bool& shrank);
+        Node* remove_rightmost(Node* n, T& max_val, bool& shrank);
+
+        Node* left_grew(Node* n, bool& grew);
+        Node* right_grew(Node* n, bool& grew);
+        Node* left_shrank(Node* n, bool& shrank);
+        Node* right_shrank(Node* n, bool& shrank);
+
+        Node* fix_left_heavy(Node* n);
+        Node* fix_right_heavy(Node* n);
+};
+
+template <typename T>
+bool CompactAVLTree<T>::insert(const T& key) {
+    bool inserted = false, grew = false;
+    root = insert(root, key, inserted, grew);
+
+    return inserted;
+}
+
+template <typename T>
+bool CompactAVLTree<T>::remove(const T& key) {
+    bool removed = false, shrank = false;
+    root = remove(root, key, removed, shrank);
+
+    return removed;
+}
+
+template <typename T>
+bool CompactAVLTree<T>::search(const T& key) const {
+    const Node* n = root;
+
+    while (n != nullptr) {
+        if      (key < n->element) n = n->left();
+        else if (key > n->element) n = n->right;
+        else                       return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+void CompactAVLTree<T>::clear() {
+    // Rotate left children up until the root has none, then free it
+    while (root != nullptr) {
+        Node* l = root->left();
+
+        if (l != nullptr) {
+            root->set_left(l->right);
+            l->right = root;
+            root = l;
+        }
+        else {
+            Node* r = root->right;
+            delete root;
+            root = r;
+        }
+    }
+
+    count = 0;
+}
+
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::insert(Node* n, const T& key, bool& inserted, bool& grew) {
+    if (n == nullptr) {
+        inserted = grew = true;
+        count++;
+
+        return new Node(key);
+    }
+
+    if (key < n->element) {
+        n->set_left(insert(n->left(), key, inserted, grew));
+        return grew ? left_grew(n, grew) : n;
+    }
+    if (key > n->element) {
+        n->right = insert(n->right, key, inserted, grew);
+        return grew ? right_grew(n, grew) : n;
+    }
+
+    return n; // Already exists
+}
+
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::remove(Node* n, const T& key, bool& removed, bool& shrank) {
+    if (n == nullptr) return nullptr;
+
+    if (key < n->element) {
+        n->set_left(remove(n->left(), key, removed, shrank));
+        return shrank ? left_shrank(n, shrank) : n;
+    }
+    if (key > n->element) {
+        n->right = remove(n->right, key, removed, shrank);
+        return shrank ? right_shrank(n, shrank) : n;
+    }
+
+    removed = true;
+
+    // Has at most one child: bypass the node
+    if (n->left() == nullptr || n->right == nullptr) {
+        Node* child = n->left() != nullptr ? n->left() : n->right;
+        delete n;
+        count--;
+        shrank = true;
+
+        return child;
+    }
+
+    // Has both children: pull the max element up from the left subtree
+    n->set_left(remove_rightmost(n->left(), n->element, shrank));
+    count--;
+
+    return shrank ? left_shrank(n, shrank) : n;
+}
+
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::remove_rightmost(Node* n, T& max_val, bool& shrank) {
+    if (n->right == nullptr) {
+        Node* child = n->left();
+        max_val = std::move(n->element);
+        delete n;
+        shrank = true;
+
+        return child;
+    }
+
+    n->right = remove_rightmost(n->right, max_val, shrank);
+    return shrank ? right_shrank(n, shrank) : n;
+}
+
+/* The left subtree of `n` got one level taller. `grew` stays set only
+   if `n` did too. */
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::left_grew(Node* n, bool& grew) {
+    int b = n->balance() + 1;
+
+    // Rotating after an insertion always restores the old height
+    if (b == 2) {
+        grew = false;
+        return fix_left_heavy(n);
+    }
+
+    n->set_balance(b);
+    grew = (b == 1);
+
+    return n;
+}
+
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::right_grew(Node* n, bool& grew) {
+    int b = n->balance() - 1;
+
+    if (b == -2) {
+        grew = false;
+        return fix_right_heavy(n);
+    }
+
+    n->set_balance(b);
+    grew = (b == -1);
+
+    return n;
+}
+
+/* The left subtree of `n` lost one level. `shrank` stays set only if
+   `n` did too. */
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::left_shrank(Node* n, bool& shrank) {
+    int b = n->balance() - 1;
+
+    if (b == -2) {
+        n = fix_right_heavy(n);
+        // A single rotation over a balanced child keeps the height
+        shrank = (n->balance() == 0);
+
+        return n;
+    }
+
+    n->set_balance(b);
+    shrank = (b == 0);
+
+    return n;
+}
+
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::right_shrank(Node* n, bool& shrank) {
+    int b = n->balance() + 1;
+
+    if (b == 2) {
+        n = fix_left_heavy(n);
+        shrank = (n->balance() == 0);
+
+        return n;
+    }
+
+    n->set_balance(b);
+    shrank = (b == 0);
+
+    return n;
+}
+
+/* `n` is two levels heavier on the left. The two bits cannot hold +2,
+   so the new balance factors come from the known cases rather than
+   from adjusting the stored ones. */
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::fix_left_heavy(Node* n) {
+    Node* l = n->left();
+    int lb = l->balance();
+
+    // Single right rotation
+    if (lb >= 0) {
+        n->set_left(l->right);
+        l->right = n;
+
+        // A balanced child happens only after a removal; the subtree
+        // keeps its height then
+        n->set_balance(lb == 0 ? 1 : 0);
+        l->set_balance(lb == 0 ? -1 : 0);
+
+        return l;
+    }
+
+    // Double rotation: the left child's right child becomes the root
+    Node* m = l->right;
+    int mb = m->balance();
+
+    l->right = m->left();
+    n->set_left(m->right);
+    m->set_left(l);
+    m->right = n;
+
+    l->set_balance(mb == -1 ? 1 : 0);
+    n->set_balance(mb == 1 ? -1 : 0);
+    m->set_balance(0);
+
+    return m;
+}
+
+template <typename T>
+typename CompactAVLTree<T>::Node* CompactAVLTree<T>::fix_right_heavy(Node* n) {
+    Node* r = n->right;
+    int rb = r->balance();
+
+    // Single left rotation
+    if (rb <= 0) {
+        n->right = r->left();
+        r->set_left(n);
+
+        n->set_balance(rb == 0 ? -1 : 0);
+        r->set_balance(rb == 0 ? 1 : 0);
+
+        return r;
+    }
+
+    Node* m = r->left();
+    int mb = m->balance();
+
+    r->set_left(m->right);
+    n->right = m->left();
+    m->set_left(n);
+    m->right = r;
+
+    n->set_balance(mb == -1 ? 1 : 0);
+    r->set_balance(mb == 1 ? -1 : 0);
+    m->set_balance(0);
+
+    return m;
+}
@@ -3,6 +3,12 @@
 #include <random>
 #include <cmath>
 #include <stack>
+#include <string>
+#include <string_view>
+#include <numeric>
+#include <map>
+#include <optional>
+#include <stdexcept>
 
 #include "AVLTree.hpp"
 
@@ -133,3 +139,784 @@ TEST_CASE("AVLTree remove test", "[AVL]") {
     }
 
 }
+
+template <typename T, typename Compare>
+bool is_AVL(const ArenaAVLTree<T, Compare>& t) {
+
+    Compare comp;
+    std::stack<uint32_t> s1;
+    size_t count = 0;
+
+    if (t.root != t.nil) s1.push(t.root);
+
+    while (!s1.empty()) {
+
+        auto& node = t.node(s1.top());
+        s1.pop();
+        count++;
+
+        int l_h = t.get_height(node.left);
+        int r_h = t.get_height(node.right);
+
+        if (std::abs(l_h - r_h) >= 2) return false;
+        if (node.height != std::max(l_h, r_h) + 1) return false;
+
+        if (node.left != t.nil) {
+            if (!comp(t.node(node.left).element, node.element)) return false;
+            s1.push(node.left);
+        }
+        if (node.right != t.nil) {
+            if (!comp(node.element, t.node(node.right).element)) return false;
+            s1.push(node.right);
+        }
+    }
+
+    return count == t.size();
+}
+
+TEST_CASE("ArenaAVLTree insert/remove test", "[AVL]") {
+
+    ArenaAVLTree<int> tree;
+
+    std::vector<int> v;
+    v.resize(1 << 12);
+    std::generate(v.begin(), v.end(), std::rand);
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    std::random_shuffle(v.begin(), v.end());
+
+    for (auto ele: v) {
+        REQUIRE(tree.insert(ele) == true);
+        REQUIRE(tree.insert(ele) == false);
+    }
+    REQUIRE(is_AVL(tree) == true);
+    REQUIRE(tree.size() == v.size());
+
+    auto x = std::vector<int>(v.begin(), v.begin() + v.size() / 2);
+
+    for (auto ele: x) {
+        REQUIRE(tree.remove(ele) == true);
+        REQUIRE(tree.remove(ele) == false);
+        REQUIRE(tree.search(ele) == false);
+    }
+    REQUIRE(is_AVL(tree) == true);
+
+    for (auto it = v.begin() + x.size(); it != v.end(); ++it)
+        REQUIRE(tree.search(*it) == true);
+
+    // Freed slots are reused before the arena grows
+    size_t bytes = tree.memory_bytes();
+    for (auto ele: x)
+        tree.insert(ele);
+    REQUIRE(tree.memory_bytes() == bytes);
+    REQUIRE(is_AVL(tree) == true);
+
+    tree.clear();
+    REQUIRE(tree.root == tree.nil);
+    REQUIRE(tree.size() == 0);
+    REQUIRE(tree.memory_bytes() == 0);
+    REQUIRE(tree.search(v[0]) == false);
+}
+
+TEST_CASE("ArenaAVLTree with non-trivial elements", "[AVL]") {
+
+    ArenaAVLTree<std::string> tree;
+
+    for (int i = 0; i < 3000; i++)
+        REQUIRE(tree.insert(std::string(40, 'a') + std::to_string(i)) == true);
+    REQUIRE(is_AVL(tree) == true);
+
+    for (int i = 0; i < 3000; i += 3)
+        REQUIRE(tree.remove(std::string(40, 'a') + std::to_string(i)) == true);
+    REQUIRE(is_AVL(tree) == true);
+    REQUIRE(tree.size() == 2000);
+
+    tree.clear();
+    REQUIRE(tree.size() == 0);
+}
+
+TEST_CASE("ArenaAVLTree with a custom Compare", "[AVL]") {
+
+    ArenaAVLTree<int, std::greater<int>> tree;
+
+    for (int i = 0; i < 1000; i++)
+        REQUIRE(tree.insert(i) == true);
+    REQUIRE(is_AVL(tree) == true);
+
+    // Under std::greater the leftmost node holds the largest key
+    uint32_t n = tree.root;
+    while (tree.node(n).left != tree.nil)
+        n = tree.node(n).left;
+    REQUIRE(tree.node(n).element == 999);
+
+    for (int i = 0; i < 1000; i += 2)
+        REQUIRE(tree.remove(i) == true);
+    REQUIRE(is_AVL(tree) == true);
+    REQUIRE(tree.search(1) == true);
+    REQUIRE(tree.search(2) == false);
+}
+
+TEST_CASE("AVLTree search test", "[AVL]") {
+
+    auto tree = std::make_unique<AVLTree<int>>();
+
+    for (int i = 0; i < 1000; i += 2)
+        tree->insert(i);
+
+    for (int i = 0; i < 1000; i++)
+        REQUIRE(tree->search(i) == (i % 2 == 0));
+}
+
+TEST_CASE("AVLTree from_sorted test", "[AVL]") {
+
+    for (int n : { 1, 2, 3, 7, 8, 1000, 1 << 15, (1 << 16) + 3 }) {
+        std::vector<int> v(n);
+        for (int i = 0; i < n; i++)
+            v[i] = 2 * i;
+
+        auto tree = std::make_unique<AVLTree<int>>();
+        auto ptree = std::make_unique<AVLTree<int>>();
+        tree->insert(-1);
+
+        tree->from_sorted(v.begin(), v.end());
+        ptree->from_sorted_parallel(v.begin(), v.end(), 3);
+
+        REQUIRE(is_AVL(tree) == true);
+        REQUIRE(is_AVL(ptree) == true);
+        REQUIRE(tree->search(-1) == false);
+
+        int levels = 0;
+        while ((1 << levels) <= n) levels++;
+        REQUIRE(tree->get_height(tree->root) == levels - 1);
+        REQUIRE(ptree->get_height(ptree->root) == levels - 1);
+
+        for (int i = 0; i < 2 * n; i++) {
+            REQUIRE(tree->search(i) == (i % 2 == 0));
+            if (i % 97 == 0) REQUIRE(ptree->search(i) == (i % 2 == 0));
+        }
+
+        // The result is an ordinary AVL tree afterwards
+        for (int i = 1; i < 2 * n; i += 2)
+            REQUIRE(tree->insert(i) == true);
+        REQUIRE(is_AVL(tree) == true);
+        // is_AVL rejects an empty tree, so keep the smallest key
+        for (int i = 1; i < n; i += 3)
+            REQUIRE(ptree->remove(2 * i) == true);
+        REQUIRE(is_AVL(ptree) == true);
+    }
+}
+
+TEST_CASE("AVLTree from_sorted of an empty range", "[AVL]") {
+
+    auto tree = std::make_unique<AVLTree<int>>();
+    tree->insert(1);
+
+    std::vector<int> v;
+    tree->from_sorted(v.begin(), v.end());
+    REQUIRE(tree->root == nullptr);
+    REQUIRE(tree->get_height(tree->root) == -1);
+}
+
+template <typename T>
+int check_sizes(std::unique_ptr<TreeNode<T>>& n) {
+    if (n == nullptr) return 0;
+
+    int size = check_sizes(n->left) + check_sizes(n->right) + 1;
+    REQUIRE(n->size == size);
+
+    return size;
+}
+
+TEST_CASE("AVLTree order statistics test", "[AVL]") {
+
+    auto tree = std::make_unique<AVLTree<int>>();
+
+    REQUIRE(tree->select(0) == std::nullopt);
+    REQUIRE(tree->rank(5) == 0);
+    REQUIRE(tree->count_range(0, 10) == 0);
+
+    std::vector<int> v;
+    v.resize(1 << 12);
+    std::generate(v.begin(), v.end(), [] { return std::rand() % 100000; });
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    std::random_shuffle(v.begin(), v.end());
+
+    for (auto ele: v)
+        tree->insert(ele);
+
+    // Removals go through every rotation case as well
+    std::vector<int> kept(v.begin() + v.size() / 3, v.end());
+    for (auto it = v.begin(); it != v.begin() + v.size() / 3; ++it)
+        REQUIRE(tree->remove(*it) == true);
+
+    // Duplicate inserts and missing removes leave the sizes alone
+    REQUIRE(tree->insert(kept[0]) == false);
+    REQUIRE(tree->remove(v[0]) == false);
+
+    REQUIRE(is_AVL(tree) == true);
+    REQUIRE(check_sizes(tree->root) == (int)kept.size());
+
+    std::sort(kept.begin(), kept.end());
+
+    for (size_t k = 0; k < kept.size(); k++)
+        REQUIRE(tree->select(k) == kept[k]);
+    REQUIRE(tree->select(kept.size()) == std::nullopt);
+
+    for (int probe = -1; probe <= 100001; probe += 37) {
+        size_t expected = std::lower_bound(kept.begin(), kept.end(), probe) - kept.begin();
+        REQUIRE(tree->rank(probe) == expected);
+    }
+    for (size_t k = 0; k < kept.size(); k += 11)
+        REQUIRE(tree->rank(kept[k]) == k);
+
+    for (int i = 0; i < 500; i++) {
+        int lo = std::rand() % 100000;
+        int hi = lo + std::rand() % 5000;
+        size_t expected = std::upper_bound(kept.begin(), kept.end(), hi)
+                        - std::lower_bound(kept.begin(), kept.end(), lo);
+        REQUIRE(tree->count_range(lo, hi) == expected);
+    }
+    REQUIRE(tree->count_range(kept.front(), kept.back()) == kept.size());
+    REQUIRE(tree->count_range(kept[5], kept[5]) == 1);
+    REQUIRE(tree->count_range(10, 5) == 0);
+}
+
+TEST_CASE("AVLTree from_sorted sets subtree sizes", "[AVL]") {
+
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+
+    auto tree = std::make_unique<AVLTree<int>>();
+    tree->from_sorted(v.begin(), v.end());
+
+    REQUIRE(check_sizes(tree->root) == 1000);
+    REQUIRE(tree->select(123) == 123);
+    REQUIRE(tree->count_range(100, 199) == 100);
+}
+
+TEST_CASE("AVLTree freeze test", "[AVL]") {
+
+    for (int n : { 0, 1, 2, 3, 6, 7, 8, 100, 1000, 4097 }) {
+        auto tree = std::make_unique<AVLTree<int>>();
+
+        std::vector<int> keys(n);
+        for (int i = 0; i < n; i++)
+            keys[i] = 3 * i;
+        std::random_shuffle(keys.begin(), keys.end());
+        for (auto k : keys)
+            tree->insert(k);
+        std::sort(keys.begin(), keys.end());
+
+        EytzingerSet<int> frozen = tree->freeze();
+        REQUIRE(frozen.size() == (size_t)n);
+        REQUIRE(frozen.empty() == (n == 0));
+
+        // Iteration yields the keys in order, both ways
+        REQUIRE(std::equal(frozen.begin(), frozen.end(), keys.begin(), keys.end()));
+        std::vector<int> backwards;
+        for (auto it = frozen.end(); it != frozen.begin(); )
+            backwards.push_back(*--it);
+        REQUIRE(std::equal(backwards.rbegin(), backwards.rend(), keys.begin(), keys.end()));
+
+        for (int probe = -2; probe <= 3 * n + 2; probe++) {
+            REQUIRE(frozen.contains(probe) == tree->search(probe));
+
+            auto lb = std::lower_bound(keys.begin(), keys.end(), probe);
+            auto it = frozen.lower_bound(probe);
+            if (lb == keys.end()) REQUIRE(it == frozen.end());
+            else                  REQUIRE(*it == *lb);
+
+            auto ub = std::upper_bound(keys.begin(), keys.end(), probe);
+            it = frozen.upper_bound(probe);
+            if (ub == keys.end()) REQUIRE(it == frozen.end());
+            else                  REQUIRE(*it == *ub);
+        }
+
+        // Range [lo, hi) through lower_bound
+        if (n >= 10) {
+            int lo = keys[n / 4] - 1, hi = keys[n / 2];
+            std::vector<int> range(frozen.lower_bound(lo), frozen.lower_bound(hi));
+            REQUIRE(range == std::vector<int>(keys.begin() + n / 4, keys.begin() + n / 2));
+        }
+
+        // The snapshot does not follow later updates
+        tree->insert(-10);
+        REQUIRE(frozen.contains(-10) == false);
+    }
+}
+
+TEST_CASE("EytzingerSet with string keys", "[AVL]") {
+
+    std::vector<std::string> words = { "apple", "banana", "cherry", "date", "elder", "fig" };
+    EytzingerSet<std::string> frozen(words.begin(), words.end());
+
+    REQUIRE(frozen.contains("cherry") == true);
+    REQUIRE(frozen.contains("coconut") == false);
+    REQUIRE(*frozen.lower_bound("coconut") == "date");
+    REQUIRE(frozen.upper_bound("fig") == frozen.end());
+    REQUIRE(std::vector<std::string>(frozen.begin(), frozen.end()) == words);
+}
+
+template <typename T>
+std::vector<T> keys_of(std::unique_ptr<TreeNode<T>>& n) {
+    std::vector<T> out;
+    std::stack<TreeNode<T>*> s;
+    TreeNode<T>* cur = n.get();
+
+    while (cur != nullptr || !s.empty()) {
+        while (cur != nullptr) {
+            s.push(cur);
+            cur = cur->left.get();
+        }
+        cur = s.top();
+        s.pop();
+        out.push_back(cur->element);
+        cur = cur->right.get();
+    }
+
+    return out;
+}
+
+static std::vector<int> random_keys(size_t n, int range) {
+    std::vector<int> v(n);
+    std::generate(v.begin(), v.end(), [=] { return std::rand() % range; });
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    std::random_shuffle(v.begin(), v.end());
+    return v;
+}
+
+static std::unique_ptr<AVLTree<int>> tree_of(const std::vector<int>& v) {
+    auto tree = std::make_unique<AVLTree<int>>();
+    for (auto ele: v)
+        tree->insert(ele);
+    return tree;
+}
+
+static bool valid_or_empty(std::unique_ptr<AVLTree<int>>& t) {
+    return t->root == nullptr || (is_AVL(t) && check_sizes(t->root) == t->root->size);
+}
+
+TEST_CASE("AVLTree join and split test", "[AVL]") {
+
+    // Trees of very different heights on either side of the key
+    for (auto sizes : { std::make_pair(0, 0), std::make_pair(1, 0), std::make_pair(0, 500),
+                        std::make_pair(1000, 3), std::make_pair(2, 3000), std::make_pair(777, 900) }) {
+        std::vector<int> lv, rv;
+        for (int i = 0; i < sizes.first; i++) lv.push_back(i);
+        for (int i = 0; i < sizes.second; i++) rv.push_back(sizes.first + 1 + i);
+        std::random_shuffle(lv.begin(), lv.end());
+        std::random_shuffle(rv.begin(), rv.end());
+
+        auto joined = std::make_unique<AVLTree<int>>(
+            AVLTree<int>::join(std::move(*tree_of(lv)), sizes.first, std::move(*tree_of(rv))));
+
+        REQUIRE(valid_or_empty(joined));
+        std::vector<int> all = keys_of(joined->root);
+        REQUIRE(all.size() == (size_t)(sizes.first + sizes.second + 1));
+        for (size_t i = 0; i < all.size(); i++)
+            REQUIRE(all[i] == (int)i);
+    }
+
+    std::vector<int> v = random_keys(3000, 10000);
+    std::vector<int> sorted = v;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (int key : { -1, sorted[0], sorted[100], sorted[100] + 1, 5000, sorted.back(), 10001 }) {
+        auto [less, found, greater] = AVLTree<int>::split(std::move(*tree_of(v)), key);
+        auto l = std::make_unique<AVLTree<int>>(std::move(less));
+        auto g = std::make_unique<AVLTree<int>>(std::move(greater));
+
+        REQUIRE(found == std::binary_search(sorted.begin(), sorted.end(), key));
+        REQUIRE(valid_or_empty(l));
+        REQUIRE(valid_or_empty(g));
+
+        auto mid = std::lower_bound(sorted.begin(), sorted.end(), key);
+        REQUIRE(keys_of(l->root) == std::vector<int>(sorted.begin(), mid));
+        if (found) ++mid;
+        REQUIRE(keys_of(g->root) == std::vector<int>(mid, sorted.end()));
+    }
+}
+
+TEST_CASE("AVLTree set operations test", "[AVL]") {
+
+    for (unsigned threads : { 1u, 4u }) {
+        for (auto sizes : { std::make_pair(0, 100), std::make_pair(100, 0), std::make_pair(50, 30000),
+                            std::make_pair(40000, 40000), std::make_pair(30000, 20) }) {
+            std::vector<int> a = random_keys(sizes.first, 100000);
+            std::vector<int> b = random_keys(sizes.second, 100000);
+            std::vector<int> sa = a, sb = b;
+            std::sort(sa.begin(), sa.end());
+            std::sort(sb.begin(), sb.end());
+
+            std::vector<int> expected;
+            std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+            auto t = tree_of(a);
+            t->union_with(std::move(*tree_of(b)), threads);
+            REQUIRE(valid_or_empty(t));
+            REQUIRE(keys_of(t->root) == expected);
+
+            expected.clear();
+            std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+            t = tree_of(a);
+            t->intersect_with(std::move(*tree_of(b)), threads);
+            REQUIRE(valid_or_empty(t));
+            REQUIRE(keys_of(t->root) == expected);
+
+            expected.clear();
+            std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+            t = tree_of(a);
+            auto other = tree_of(b);
+            t->difference_with(std::move(*other), threads);
+            REQUIRE(other->root == nullptr);
+            REQUIRE(valid_or_empty(t));
+            REQUIRE(keys_of(t->root) == expected);
+        }
+    }
+}
+
+TEST_CASE("AVLTree ordered iteration and range test", "[AVL]") {
+
+    auto tree = std::make_unique<AVLTree<int>>();
+    REQUIRE(tree->begin() == tree->end());
+
+    std::vector<int> v = random_keys(5000, 50000);
+    for (auto ele: v)
+        tree->insert(ele);
+    std::sort(v.begin(), v.end());
+
+    REQUIRE(std::vector<int>(tree->begin(), tree->end()) == v);
+    REQUIRE(keys_of(tree->root) == v);
+
+    for (int probe = -1; probe <= 50001; probe += 13) {
+        auto lb = std::lower_bound(v.begin(), v.end(), probe);
+        auto it = tree->lower_bound(probe);
+        REQUIRE((it == tree->end()) == (lb == v.end()));
+        if (lb != v.end()) REQUIRE(*it == *lb);
+
+        auto ub = std::upper_bound(v.begin(), v.end(), probe);
+        it = tree->upper_bound(probe);
+        REQUIRE((it == tree->end()) == (ub == v.end()));
+        if (ub != v.end()) REQUIRE(*it == *ub);
+    }
+
+    for (int i = 0; i < 200; i++) {
+        int lo = std::rand() % 50000;
+        int hi = lo + std::rand() % 3000;
+
+        std::vector<int> got;
+        tree->for_each_in_range(lo, hi, [&](int k) { got.push_back(k); });
+        REQUIRE(got == std::vector<int>(std::lower_bound(v.begin(), v.end(), lo),
+                                        std::lower_bound(v.begin(), v.end(), hi)));
+        REQUIRE(got.size() == tree->count_range(lo, hi - 1));
+    }
+
+    // Iterators work with the standard algorithms
+    REQUIRE(std::is_sorted(tree->begin(), tree->end()));
+    REQUIRE(*std::find_if(tree->begin(), tree->end(), [&](int k) { return k > v[100]; }) == v[101]);
+}
+
+/* Returns the height of `n`, checking order and every stored balance */
+template <typename T>
+int check_compact(const CompactTreeNode<T>* n, size_t& count) {
+    if (n == nullptr) return -1;
+
+    if (n->left() != nullptr) REQUIRE(n->left()->element < n->element);
+    if (n->right != nullptr)  REQUIRE(n->element < n->right->element);
+
+    int l_h = check_compact(n->left(), count);
+    int r_h = check_compact(n->right, count);
+    REQUIRE(n->balance() == l_h - r_h);
+    count++;
+
+    return std::max(l_h, r_h) + 1;
+}
+
+TEST_CASE("CompactAVLTree insert/remove test", "[AVL]") {
+
+    REQUIRE(sizeof(CompactTreeNode<int>) <= 3 * sizeof(void*));
+    REQUIRE(sizeof(CompactTreeNode<long long>) <= 3 * sizeof(void*));
+
+    CompactAVLTree<int> tree;
+    size_t count = 0;
+
+    std::vector<int> v = random_keys(1 << 12, 100000);
+    for (auto ele: v) {
+        REQUIRE(tree.insert(ele) == true);
+        REQUIRE(tree.insert(ele) == false);
+    }
+    REQUIRE(check_compact(tree.root, count) <= 1.45 * std::log2(v.size() + 2));
+    REQUIRE(count == v.size());
+    REQUIRE(tree.size() == v.size());
+
+    std::random_shuffle(v.begin(), v.end());
+    auto x = std::vector<int>(v.begin(), v.begin() + v.size() / 2);
+
+    for (size_t i = 0; i < x.size(); i++) {
+        REQUIRE(tree.remove(x[i]) == true);
+        REQUIRE(tree.remove(x[i]) == false);
+        REQUIRE(tree.search(x[i]) == false);
+
+        if (i % 97 == 0) {
+            count = 0;
+            check_compact(tree.root, count);
+            REQUIRE(count == tree.size());
+        }
+    }
+    count = 0;
+    check_compact(tree.root, count);
+    REQUIRE(count == v.size() - x.size());
+
+    for (auto it = v.begin() + x.size(); it != v.end(); ++it)
+        REQUIRE(tree.search(*it) == true);
+
+    tree.clear();
+    REQUIRE(tree.root == nullptr);
+    REQUIRE(tree.size() == 0);
+}
+
+TEST_CASE("CompactAVLTree sorted inserts and removes", "[AVL]") {
+
+    CompactAVLTree<std::string> tree;
+    size_t count = 0;
+
+    // Ascending then descending keys hit every rotation shape
+    for (int i = 0; i < 2000; i++)
+        tree.insert(std::to_string(100000 + i));
+    for (int i = 0; i < 2000; i++)
+        tree.insert(std::to_string(99999 - i));
+    REQUIRE(check_compact(tree.root, count) <= 13);
+    REQUIRE(count == 4000);
+
+    for (int i = 0; i < 2000; i++)
+        REQUIRE(tree.remove(std::to_string(98000 + 2 * i)) == true);
+    count = 0;
+    check_compact(tree.root, count);
+    REQUIRE(count == 2000);
+}
+
+TEST_CASE("AVLTree heterogeneous lookup and custom Compare", "[AVL]") {
+
+    // std::less<> is transparent, so string_view and C strings are
+    // compared against the stored std::string directly
+    AVLTree<std::string, std::less<>> tree;
+    for (int i = 0; i < 1000; i++)
+        REQUIRE(tree.insert("key" + std::to_string(i)) == true);
+
+    std::string_view sv = "key42";
+    REQUIRE(tree.search(sv) == true);
+    REQUIRE(tree.search("key999") == true);
+    REQUIRE(tree.search("key1000") == false);
+    REQUIRE(*tree.find(sv) == "key42");
+    REQUIRE(tree.find("nope") == tree.end());
+    REQUIRE(*tree.lower_bound("key5") == "key5");
+    REQUIRE(*tree.upper_bound("key5") == "key50");
+
+    REQUIRE(tree.remove(sv) == true);
+    REQUIRE(tree.remove(sv) == false);
+    REQUIRE(tree.search(std::string("key42")) == false);
+    REQUIRE(tree.get_size(tree.root) == 999);
+
+    // A reversed order is honoured by queries, order statistics and
+    // split/join
+    AVLTree<int, std::greater<int>> rev;
+    for (int i = 0; i < 100; i++)
+        rev.insert(i);
+    REQUIRE(*rev.begin() == 99);
+    REQUIRE(*rev.select(0) == 99);
+    REQUIRE(rev.rank(90) == 9);
+    REQUIRE(rev.count_range(60, 51) == 10);
+    REQUIRE(*rev.upper_bound(50) == 49);
+    REQUIRE(*rev.find(7) == 7);
+    REQUIRE(rev.remove(7) == true);
+    REQUIRE(rev.search(7) == false);
+
+    auto [hi, found, lo] = AVLTree<int, std::greater<int>>::split(std::move(rev), 50);
+    REQUIRE(found == true);
+    REQUIRE(*hi.begin() == 99);
+    REQUIRE(*lo.begin() == 49);
+    REQUIRE(hi.get_size(hi.root) == 49);
+    REQUIRE(lo.get_size(lo.root) == 49);
+
+    EytzingerSet<int, std::greater<int>> frozen = lo.freeze();
+    REQUIRE(*frozen.begin() == 49);
+    REQUIRE(*frozen.lower_bound(20) == 20);
+    REQUIRE(frozen.contains(7) == false);
+}
+
+// Counts copies, so tests can tell whether a descent copies stored keys
+struct CountedKey {
+    static inline int copies = 0;
+    int v;
+
+    CountedKey(int v) : v(v) {}
+    CountedKey(const CountedKey& o) : v(o.v) { copies++; }
+    CountedKey& operator=(const CountedKey& o) { v = o.v; copies++; return *this; }
+    CountedKey(CountedKey&&) = default;
+    CountedKey& operator=(CountedKey&&) = default;
+};
+
+struct CountedLess {
+    using is_transparent = void;
+    static int key(const CountedKey& k) { return k.v; }
+    static int key(int v) { return v; }
+
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const { return key(a) < key(b); }
+};
+
+TEST_CASE("AVLTree probes do not copy stored keys", "[AVL]") {
+    AVLTree<CountedKey, CountedLess> tree;
+    for (int i = 0; i < 1024; i++)
+        tree.insert(CountedKey(2 * i));
+
+    // Each successful insert copies the new key into its node, and no more
+    CountedKey::copies = 0;
+    REQUIRE(tree.insert(CountedKey(5)) == true);
+    REQUIRE(tree.insert(CountedKey(5)) == false);
+    REQUIRE(CountedKey::copies == 1);
+
+    // Removing a leaf, or missing, copies nothing
+    CountedKey::copies = 0;
+    REQUIRE(tree.remove(5) == true);
+    REQUIRE(tree.remove(7) == false);
+    REQUIRE(tree.search(8) == true);
+    REQUIRE(CountedKey::copies == 0);
+}
+
+TEST_CASE("AVLMap agrees with std::map", "[AVL]") {
+
+    AVLMap<int, std::string> map;
+    std::map<int, std::string> ref;
+    std::mt19937 rng(7);
+
+    for (int i = 0; i < 20000; i++) {
+        int key = rng() % 2000;
+        std::string val = std::to_string(rng());
+
+        switch (rng() % 4) {
+            case 0: {
+                auto [v, inserted] = map.try_emplace(key, val);
+                auto r = ref.try_emplace(key, val);
+                REQUIRE(inserted == r.second);
+                REQUIRE(*v == r.first->second);
+                break;
+            }
+            case 1: {
+                auto [v, inserted] = map.insert_or_assign(key, val);
+                REQUIRE(inserted == ref.insert_or_assign(key, val).second);
+                REQUIRE(*v == val);
+                break;
+            }
+            case 2:
+                REQUIRE(map.erase(key) == (ref.erase(key) == 1));
+                break;
+            default:
+                REQUIRE(map.update(key, [](std::string& s) { s += "!"; }) ==
+                        (ref.count(key) == 1));
+                if (ref.count(key)) ref[key] += "!";
+        }
+    }
+
+    REQUIRE(map.size() == ref.size());
+
+    for (int key = 0; key < 2000; key++) {
+        const std::string* v = map.find(key);
+        auto it = ref.find(key);
+        REQUIRE((v == nullptr) == (it == ref.end()));
+        REQUIRE(map.contains(key) == (it != ref.end()));
+        if (v != nullptr) REQUIRE(*v == it->second);
+    }
+
+    std::vector<std::pair<int, std::string>> got;
+    map.for_each([&](int k, const std::string& v) { got.emplace_back(k, v); });
+    REQUIRE(got == std::vector<std::pair<int, std::string>>(ref.begin(), ref.end()));
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.find(got[0].first) == nullptr);
+}
+
+TEST_CASE("AVLMap reuses erased slots and keeps try_emplace lazy", "[AVL]") {
+
+    struct Counted {
+        int* made = nullptr;
+        Counted() = default;
+        explicit Counted(int* m) : made(m) { (*made)++; }
+    };
+
+    AVLMap<std::string, Counted, std::greater<std::string>> map;
+    int made = 0;
+
+    REQUIRE(map.try_emplace("b", &made).second == true);
+    REQUIRE(map.try_emplace("b", &made).second == false);
+    REQUIRE(made == 1);
+
+    for (int i = 0; i < 100; i++)
+        map.try_emplace(std::to_string(i), &made);
+    const Counted* kept = map.find("1");
+    const Counted* freed_last = map.find("98");
+
+    // Erasing and refilling recycles slots, most recently freed first,
+    // so the array never grows and existing values are not moved
+    for (int i = 0; i < 100; i += 2)
+        REQUIRE(map.erase(std::to_string(i)) == true);
+    for (int i = 0; i < 50; i++)
+        map.try_emplace("x" + std::to_string(i), &made);
+    REQUIRE(map.find("0") == nullptr);
+    REQUIRE(map.find("1") == kept);
+    REQUIRE(map.find("x0") == freed_last);
+    REQUIRE(made == 151);
+    REQUIRE(map.size() == 101);
+
+    std::vector<std::string> keys;
+    map.for_each([&](const std::string& k, const Counted&) { keys.push_back(k); });
+    REQUIRE(std::is_sorted(keys.rbegin(), keys.rend()));
+}
+
+TEST_CASE("AVLMap leaves no entry behind when a value throws", "[AVL]") {
+
+    struct Picky {
+        int v = 0;
+        Picky() = default;
+        explicit Picky(int v) : v(v) { if (v < 0) throw std::invalid_argument("negative"); }
+    };
+
+    AVLMap<int, Picky> map;
+    REQUIRE(map.try_emplace(1, 10).second == true);
+    REQUIRE(map.try_emplace(2, 20).second == true);
+
+    // Throwing while appending a new slot
+    REQUIRE_THROWS_AS(map.try_emplace(3, -1), std::invalid_argument);
+    REQUIRE(map.find(3) == nullptr);
+    REQUIRE(map.size() == 2);
+
+    // Throwing while refilling an erased slot keeps the slot free
+    REQUIRE(map.erase(1) == true);
+    REQUIRE_THROWS_AS(map.try_emplace(4, -1), std::invalid_argument);
+    REQUIRE(map.contains(4) == false);
+    REQUIRE(map.size() == 1);
+
+    REQUIRE(map.try_emplace(5, 50).second == true);
+    REQUIRE(map.try_emplace(6, 60).second == true);
+    REQUIRE(map.find(5)->v == 50);
+    REQUIRE(map.find(6)->v == 60);
+    REQUIRE(map.find(2)->v == 20);
+
+    std::vector<int> keys;
+    map.for_each([&](int k, const Picky& p) { keys.push_back(k); REQUIRE(p.v == 10 * k); });
+    REQUIRE(keys == std::vector<int>{ 2, 5, 6 });
+}
+
+TEST_CASE("AVLTree extract hands back the removed key", "[AVL]") {
+    AVLTree<std::string, std::less<>> tree;
+    for (int i = 0; i < 200; i++)
+        tree.insert("k" + std::to_string(i));
+
+    std::optional<std::string> got = tree.extract(std::string_view("k17"));
+    REQUIRE(got == std::string("k17"));
+    REQUIRE(tree.extract("k17") == std::nullopt);
+    REQUIRE(tree.search("k17") == false);
+    REQUIRE(tree.get_size(tree.root) == 199);
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "btree.hpp"
+
+static constexpr size_t B = 16;
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50'000'000;
+
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    auto* btree = new BTree<int, B>;
+    auto* bplus = new BPlusTree<int, B>;
+
+    double build_b = elapsed_ms([&] { for (int k : keys) btree->insert(k); });
+    double build_p = elapsed_ms([&] { for (int k : keys) bplus->insert(k); });
+    keys = std::vector<int>();
+
+    std::printf("%zu keys, B = %zu; build %.0f ms (BTree), %.0f ms (BPlusTree)\n\n",
+                n, B, build_b, build_p);
+    std::printf("%-6s %12s %18s %18s\n", "scan", "keys", "for_all ms", "range ms");
+
+    for (double fraction : { 0.01, 0.10, 1.0 }) {
+        int width = (int)(fraction * n);
+        int lo = fraction < 1.0 ? (int)(rng() % (n - width)) : 0;
+        int hi = lo + width;
+        long sums[2] = {};
+
+        // BTree has no ordered seek, so a range scan is a full in-order
+        // traversal that skips keys outside [lo, hi)
+        double full = elapsed_ms([&] {
+            btree->for_all([&](int& k) { if (lo <= k && k < hi) sums[0] += k; });
+        });
+        double range = elapsed_ms([&] {
+            for (int k : bplus->range(lo, hi))
+                sums[1] += k;
+        });
+
+        if (sums[0] != sums[1]) {
+            std::printf("result mismatch\n");
+            return 1;
+        }
+
+        std::printf("%5.0f%% %12d %18.1f %18.1f\n", fraction * 100, width, full, range);
+    }
+
+    delete btree;
+    delete bplus;
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "btree.hpp"
+
+static constexpr size_t B = 32;
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/* Build one tree, then print its build time, shape and lookup cost.
+   Each build runs in its own child process, so none of them starts
+   with a heap the previous one already faulted in. */
+template <typename Build>
+static void report(const char* name, const std::vector<int>& probes, Build&& build) {
+    std::fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid != 0) {
+        int status;
+        waitpid(pid, &status, 0);
+        return;
+    }
+
+    auto* tree = new BTree<int, B>;
+    double ms = elapsed_ms([&] { build(*tree); });
+
+    size_t nodes = 0, keys = 0;
+    tree->for_all_nodes([&](const BTreeNode<int, B>& node) {
+        nodes++;
+        keys += node.n;
+    });
+
+    size_t found = 0;
+    double q = elapsed_ms([&] {
+        for (int p : probes)
+            found += BTreeNode<int, B>::search(tree->root, p).first != nullptr;
+    }) * 1e6 / probes.size();
+
+    std::printf("%-24s %10.0f %6zu %10zu %8.1f%% %12.1f\n", name, ms, tree->depth().value(),
+                nodes, 100.0 * keys / (nodes * (2 * B - 1)), q);
+    if (found != probes.size()) std::printf("lookup failed\n");
+
+    std::fflush(stdout);
+    _exit(0);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20'000'000;
+    size_t threads = std::max(2u, std::thread::hardware_concurrency());
+
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+
+    std::mt19937 rng(42);
+    std::vector<int> probes(1'000'000);
+    for (auto& p : probes)
+        p = rng() % n;
+
+    std::printf("%zu sorted keys, B = %zu, %u hardware threads\n\n", n, B,
+                std::thread::hardware_concurrency());
+    std::printf("%-24s %10s %6s %10s %9s %12s\n", "build", "ms", "depth", "nodes", "fill",
+                "lookup ns");
+
+    report("insert, sorted", probes, [&](BTree<int, B>& t) {
+        for (int k : keys) t.insert(k);
+    });
+
+    std::vector<int> shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    report("insert, shuffled", probes, [&](BTree<int, B>& t) {
+        for (int k : shuffled) t.insert(k);
+    });
+    shuffled = std::vector<int>();
+
+    for (double fill : { 1.0, 0.7, 0.5 }) {
+        char name[32];
+        std::snprintf(name, sizeof name, "bulk_load, fill %.1f", fill);
+        report(name, probes, [&](BTree<int, B>& t) {
+            t.bulk_load(keys.begin(), keys.end(), fill);
+        });
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof name, "bulk_load, %zu threads", threads);
+    report(name, probes, [&](BTree<int, B>& t) {
+        t.bulk_load(keys.begin(), keys.end(), 1.0, threads);
+    });
+
+    return 0;
+}
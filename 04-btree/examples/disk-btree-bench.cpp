@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+
+#include "disk_btree.hpp"
+
+// A bijection on uint32_t, so keys are distinct and in no useful order
+static uint32_t key_of(uint32_t i) { return i * 2654435761u; }
+
+template <typename F>
+static double elapsed_ns(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t pool_pages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+    size_t lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200'000;
+    std::string path = (std::filesystem::temp_directory_path() / "disk-btree-bench.db").string();
+
+    std::mt19937 rng(42);
+
+    std::printf("pool %zu pages of 4 KiB, B = %zu\n\n%8s %10s %8s %12s %10s %12s %10s\n",
+                pool_pages, DiskBTree<uint32_t>::B, "working", "keys", "pages",
+                "insert ns", "miss %", "lookup ns", "miss %");
+
+    for (double fraction : { 0.1, 0.5, 1.0, 2.0, 5.0, 10.0 }) {
+        std::filesystem::remove(path);
+
+        DiskBTree<uint32_t> tree;
+        if (!tree.open(path, pool_pages)) {
+            std::printf("cannot open %s\n", path.c_str());
+            return 1;
+        }
+
+        // Grow the tree until it spans the target number of pages
+        size_t target = std::max<size_t>(2, fraction * pool_pages);
+        uint32_t n = 0;
+
+        double insert = elapsed_ns([&] {
+            while (tree.page_count() < target)
+                for (int i = 0; i < 256; i++)
+                    tree.insert(key_of(n++));
+        });
+        double insert_miss = 100.0 * tree.pool->misses / (tree.pool->hits + tree.pool->misses);
+        tree.flush();
+
+        tree.pool->hits = tree.pool->misses = 0;
+        size_t found = 0;
+
+        double lookup = elapsed_ns([&] {
+            for (size_t i = 0; i < lookups; i++)
+                found += tree.contains(key_of(rng() % n));
+        });
+        double lookup_miss = 100.0 * tree.pool->misses / (tree.pool->hits + tree.pool->misses);
+
+        if (found != lookups) {
+            std::printf("lookup failed\n");
+            return 1;
+        }
+
+        std::printf("%7.0f%% %10u %8zu %12.1f %10.2f %12.1f %10.2f\n", fraction * 100, n,
+                    tree.page_count(), insert / n, insert_miss, lookup / lookups, lookup_miss);
+
+        tree.close();
+    }
+
+    std::filesystem::remove(path);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "btree.hpp"
+
+/* An int that get_index cannot vectorize, so it takes the branchless
+   binary search */
+struct Boxed
+{
+    int v;
+
+    bool operator<(const Boxed& o) const { return v < o.v; }
+    bool operator==(const Boxed& o) const { return v == o.v; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Boxed& b) { return os << b.v; }
+
+/* The lookup as it was before: a scalar scan with an early exit */
+template<typename T, size_t B>
+static bool linear_search(const BTreeNode<T, B>* node, const T& t) {
+    while (node) {
+        size_t i = 0;
+        while (i < node->n && node->keys[i] < t)
+            ++i;
+
+        if (i < node->n && node->keys[i] == t)
+            return true;
+        if (node->type == NodeType::LEAF)
+            return false;
+
+        node = node->edges[i];
+    }
+
+    return false;
+}
+
+template <typename F>
+static double ns_per_op(size_t ops, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+template<size_t B>
+static void run(const std::vector<int>& keys, const std::vector<int>& probes) {
+    auto* tree = new BTree<int, B>;
+    auto* boxed = new BTree<Boxed, B>;
+    size_t hits[3] = {};
+
+    double insert = ns_per_op(keys.size(), [&] { for (int k : keys) tree->insert(k); });
+    for (int k : keys)
+        boxed->insert(Boxed{ k });
+
+    double simd = ns_per_op(probes.size(), [&] {
+        for (int p : probes) hits[0] += BTreeNode<int, B>::search(tree->root, p).first != nullptr;
+    });
+    double linear = ns_per_op(probes.size(), [&] {
+        for (int p : probes) hits[1] += linear_search<int, B>(tree->root, p);
+    });
+    double binary = ns_per_op(probes.size(), [&] {
+        for (int p : probes) hits[2] += BTreeNode<Boxed, B>::search(boxed->root, Boxed{ p }).first != nullptr;
+    });
+
+    if (hits[0] != hits[1] || hits[1] != hits[2])
+        std::printf("result mismatch\n");
+
+    std::printf("%4zu %6zu %12.1f %12.1f %12.1f %14.1f\n", B, *tree->depth() + 1,
+                insert, linear, simd, binary);
+
+    delete tree;
+    delete boxed;
+}
+
+template<size_t... Bs>
+static void sweep(std::index_sequence<Bs...>, const std::vector<int>& keys,
+                  const std::vector<int>& probes) {
+    (run<(size_t)1 << (Bs + 1)>(keys, probes), ...);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    // About half of the probes miss
+    std::vector<int> probes(n);
+    for (auto& p : probes)
+        p = rng() % (2 * n);
+
+    std::printf("%zu keys, %zu probes, ns/op\n\n%4s %6s %12s %12s %12s %14s\n", n, n,
+                "B", "levels", "insert", "linear", "simd", "branchless");
+
+    // B = 2, 4, ..., 64
+    sweep(std::make_index_sequence<6>{}, keys, probes);
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "mapped_btree.hpp"
+
+static constexpr size_t B = 32;
+
+template <typename F>
+static double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static long rss_kb() {
+    FILE* f = std::fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = -1;
+
+    while (f && std::fgets(line, sizeof line, f))
+        if (std::strncmp(line, "VmRSS:", 6) == 0)
+            kb = std::atol(line + 6);
+
+    if (f) std::fclose(f);
+    return kb;
+}
+
+/* Run `f` in a child process so each startup path has its own RSS */
+template <typename F>
+static void in_child(F&& f) {
+    std::fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        f();
+        std::fflush(stdout);
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+template <typename Tree>
+static double query_ns(const Tree& tree, const std::vector<int>& probes, size_t& found) {
+    return elapsed_ms([&] {
+        for (int p : probes) found += tree.contains(p);
+    }) * 1e6 / probes.size();
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20'000'000;
+    std::string path = (std::filesystem::temp_directory_path() / "snapshot-bench.snap").string();
+
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::vector<int> probes(1'000'000);
+    for (auto& p : probes)
+        p = rng() % n;
+
+    // Build the snapshot in a child too, so the freed tree does not stay
+    // resident in the heap the other children inherit
+    in_child([&] {
+        BTree<int, B> tree;
+        for (int k : keys)
+            tree.insert(k);
+
+        double save = elapsed_ms([&] { tree.save_snapshot(path); });
+        std::printf("%zu keys, B = %zu; save_snapshot %.0f ms, %.1f MiB file\n\n", n, B, save,
+                    std::filesystem::file_size(path) / 1048576.0);
+    });
+    std::printf("%-22s %16s %14s %14s %16s\n", "startup", "first query ms", "RSS MiB",
+                "query ns", "RSS after MiB");
+
+    in_child([&] {
+        long rss0 = rss_kb();
+        auto* tree = new BTree<int, B>;
+        bool hit = false;
+
+        double first = elapsed_ms([&] {
+            for (int k : keys)
+                tree->insert(k);
+            hit = BTreeNode<int, B>::search(tree->root, probes[0]).first != nullptr;
+        });
+        long rss1 = rss_kb();
+
+        // BTree has no const lookup; count hits through search
+        size_t found = 0;
+        double q = elapsed_ms([&] {
+            for (int p : probes)
+                found += BTreeNode<int, B>::search(tree->root, p).first != nullptr;
+        }) * 1e6 / probes.size();
+
+        std::printf("%-22s %16.1f %14.1f %14.1f %16.1f\n", "BTree::insert rebuild", first,
+                    (rss1 - rss0) / 1024.0, q, (rss_kb() - rss0) / 1024.0);
+        if (!hit || found != probes.size()) std::printf("lookup failed\n");
+    });
+
+    in_child([&] {
+        // Start with the snapshot out of the page cache, as after a reboot
+        int fd = open(path.c_str(), O_RDONLY);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+
+        long rss0 = rss_kb();
+        MappedBTree<int> mapped;
+        bool hit = false;
+
+        double first = elapsed_ms([&] {
+            mapped.open(path);
+            hit = mapped.contains(probes[0]);
+        });
+        long rss1 = rss_kb();
+
+        size_t found = 0;
+        double q = query_ns(mapped, probes, found);
+
+        std::printf("%-22s %16.3f %14.1f %14.1f %16.1f\n", "MappedBTree::open", first,
+                    (rss1 - rss0) / 1024.0, q, (rss_kb() - rss0) / 1024.0);
+        if (!hit || found != probes.size()) std::printf("lookup failed\n");
+    });
+
+    std::filesystem::remove(path);
+
+    return 0;
+}
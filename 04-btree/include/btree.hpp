@@ -1,3 +1,5 @@
+#pragma once
+
 #include <cstddef>
 #include <array>
 #include <iostream>
@@ -8,9 +10,136 @@
 #include <string>
 #include <sstream>
 #include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include <future>
+#include <cmath>
+#include <cassert>
 
 enum class NodeType { LEAF, INTERNAL };
 
+/* Key types keys_lower_bound can compare with SIMD vector
+   instructions, and the vector width used: one AVX2 register when the
+   build targets it, one SSE register otherwise. */
+template<typename T>
+inline constexpr bool simd_searchable =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+#if defined(__AVX2__)
+inline constexpr size_t simd_bytes = 32;
+#else
+inline constexpr size_t simd_bytes = 16;
+#endif
+
+/* Binary search whose only data-dependent step is a conditional move,
+   for keys that cannot go in a vector register */
+template<typename T>
+size_t branchless_lower_bound(const T* keys, size_t n, const T& t) {
+    if (n == 0)
+        return 0;
+
+    const T* base = keys;
+    size_t len = n;
+
+    while (len > 1) {
+        size_t half = len / 2;
+        base = (base[half] < t) ? base + half : base;
+        len -= half;
+    }
+
+    return (base - keys) + (*base < t);
+}
+
+/* The index is the number of keys less than t, so for plain numbers we
+   can compare a whole vector of keys against t at once and add up the
+   lanes that matched, with no branch on the data. Only keys[0..n) are
+   loaded; node slots past n hold stale keys.
+
+   The lanes that add up the matches are as wide as a key, so for 1- and
+   2-byte keys they are drained into `count` before they can overflow:
+   every 127 vectors for 1-byte keys. */
+template<typename T>
+size_t count_less_simd(const T* keys, size_t n, const T& t) {
+    if constexpr (simd_searchable<T>) {
+        typedef T vec __attribute__((vector_size(simd_bytes)));
+        using mask = decltype(vec{} < vec{});   // lanes are 0 or -1
+        constexpr size_t lanes = simd_bytes / sizeof(T);
+        constexpr size_t max_rounds =
+            sizeof(T) < 4 ? (size_t{1} << (8 * sizeof(T) - 1)) - 1 : SIZE_MAX;
+
+        const vec key = vec{} + t;
+        mask matched = {};
+        size_t count = 0;
+        size_t i = 0;
+
+        auto drain = [&] {
+            for (size_t l = 0; l < lanes; l++)
+                count -= matched[l];
+            matched = mask{};
+        };
+
+        for (size_t rounds = 0; i + lanes <= n; i += lanes) {
+            vec v;
+            std::memcpy(&v, &keys[i], sizeof v);
+            matched += (v < key);
+
+            if constexpr (max_rounds != SIZE_MAX) {
+                if (++rounds == max_rounds) {
+                    drain();
+                    rounds = 0;
+                }
+            }
+        }
+
+        drain();
+
+        for (; i < n; i++)
+            count += keys[i] < t;
+
+        return count;
+    }
+
+    return branchless_lower_bound(keys, n, t);
+}
+
+/* Index of the first of the n sorted keys that is not less than t,
+   searched the fastest way the key type allows */
+template<typename T>
+size_t keys_lower_bound(const T* keys, size_t n, const T& t) {
+    if constexpr (simd_searchable<T>)
+        return count_less_simd(keys, n, t);
+    else
+        return branchless_lower_bound(keys, n, t);
+}
+
+/* Layout of a file written by BTree::save_snapshot and read by
+ * MappedBTree. A header page is followed, from offset snapshot_page_size,
+ * by one fixed-size record per node in breadth-first order:
+ *
+ *     uint32_t n;            number of keys
+ *     uint32_t first_child;  record index of edge 0, snapshot_leaf in leaves
+ *     T keys[node_keys];     at offset keys_offset
+ *
+ * Breadth-first order puts the children of a node in consecutive
+ * records, so the first child's index is the only link needed, and the
+ * file holds no pointers. The file is padded to whole pages. */
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t key_size;
+    uint32_t node_keys;
+    uint32_t keys_offset;
+    uint32_t record_size;
+    uint64_t node_count;
+    uint64_t key_count;
+};
+
+inline constexpr char snapshot_magic[8] = { 'B', 'T', 'S', 'N', 'A', 'P', '0', '1' };
+inline constexpr size_t snapshot_page_size = 4096;
+inline constexpr uint32_t snapshot_leaf = UINT32_MAX;
+
 template<typename T, size_t B = 6>
 struct BTreeNode;
 
@@ -23,6 +152,15 @@ struct BTree {
     bool insert(const T&);
     bool remove(const T&);
 
+    // Replace the contents with the sorted keys in [first, last), built
+    // bottom-up in one pass. Nodes get `fill` of their 2B - 1 key slots,
+    // but never fewer than B - 1 keys; the leaves are split into runs
+    // built on `threads` threads. The keys must be strictly increasing
+    // (checked by assert). If an allocation or key copy throws, the
+    // exception reaches the caller, nothing leaks, and the tree is empty.
+    template<typename RandomIt>
+    void bulk_load(RandomIt first, RandomIt last, double fill = 1.0, size_t threads = 1);
+
     void for_all(std::function<void(T&)>);
     void for_all_nodes(std::function<void(const BTreeNode<T,B>&)>);
 
@@ -30,6 +168,10 @@ struct BTree {
     const std::optional<size_t> depth() const;
 
     std::string format(void) const;
+
+    // Write the tree in the SnapshotHeader format, for MappedBTree.
+    // Returns false if the file cannot be written.
+    bool save_snapshot(const std::string& path) const;
 };
 
 template<typename T, size_t B>
@@ -49,7 +191,7 @@ struct BTreeNode {
     ~BTreeNode();
 
     bool insert(const T& t);
-    size_t get_index(const T& t);
+    size_t get_index(const T& t) const;
 
     void for_all(std::function<void(T&)> func);
 
@@ -103,6 +245,134 @@ bool BTree<T, B>::insert(const T& t) {
     return root->insert(t);
 }
 
+/* Leaf i holds the keys after the first i leaves and the separator
+   behind each of them, so every leaf knows where its keys start and runs
+   of leaves can be built independently. Each level above then takes its
+   children and the separators between them in groups, and the separator
+   between two groups moves up a level. Every key is copied once per
+   level it lands on, so the whole build is O(n). */
+template<typename T, size_t B>
+template<typename RandomIt>
+void BTree<T, B>::bulk_load(RandomIt first, RandomIt last, double fill, size_t threads) {
+    using Node = BTreeNode<T, B>;
+
+    assert(std::adjacent_find(first, last, [](const T& a, const T& b) { return !(a < b); }) == last);
+
+    if (root) delete root;
+    root = nullptr;
+
+    size_t n = last - first;
+    if (n == 0)
+        return;
+
+    size_t per_node = std::lround(std::clamp(fill, 0.0, 1.0) * (2 * B - 1));
+    per_node = std::clamp<size_t>(per_node, B - 1, 2 * B - 1);
+
+    /* Split `units` (children, or gaps around keys for leaves) among as
+       few nodes as per_node allows, as long as each node keeps at least
+       B units; a lone root may have fewer. */
+    auto nodes_for = [per_node](size_t units) {
+        size_t wanted = (units + per_node) / (per_node + 1);
+        return std::max<size_t>(1, std::min(wanted, units / B));
+    };
+
+    size_t leaves = nodes_for(n + 1);
+    size_t q = (n - (leaves - 1)) / leaves;
+    size_t r = (n - (leaves - 1)) % leaves;
+
+    std::vector<Node*> level(leaves, nullptr);
+    std::vector<T> separators(leaves - 1);
+
+    /* Built nodes not yet adopted by a parent; on failure they are all
+       the tree there is */
+    auto drop = [](std::vector<Node*>& nodes) {
+        for (Node* node : nodes)
+            if (node) delete node;
+    };
+
+    auto build_leaves = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            RandomIt keys = first + (i * (q + 1) + std::min(i, r));
+            size_t k = q + (i < r);
+
+            level[i] = new Node(keys, keys + k);
+            if (i + 1 < leaves)
+                separators[i] = keys[k];
+        }
+    };
+
+    /* Futures carry a worker's exception back here. Every run is waited
+       for before cleaning up, since the others still write to `level`. */
+    threads = std::clamp<size_t>(threads, 1, leaves);
+    std::vector<std::future<void>> runs;
+    std::exception_ptr error;
+
+    try {
+        for (size_t t = 1; t < threads; t++)
+            runs.push_back(std::async(std::launch::async, build_leaves,
+                                      leaves * t / threads, leaves * (t + 1) / threads));
+        build_leaves(0, leaves / threads);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    for (auto& run : runs) {
+        try {
+            run.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    if (error) {
+        drop(level);
+        std::rethrow_exception(error);
+    }
+
+    while (level.size() > 1) {
+        size_t children = level.size();
+        size_t parents = nodes_for(children);
+        size_t per_parent = children / parents;
+        size_t extra = children % parents;
+
+        std::vector<Node*> up;
+        std::vector<T> up_separators;
+        size_t c = 0;
+
+        try {
+            up.assign(parents, nullptr);
+            up_separators.resize(parents - 1);
+
+            for (size_t i = 0; i < parents; i++) {
+                size_t k = per_parent + (i < extra);
+                Node* node = new Node();
+                up[i] = node;
+
+                std::copy(separators.data() + c, separators.data() + c + k - 1, node->keys.begin());
+                if (i + 1 < parents)
+                    up_separators[i] = separators[c + k - 1];
+
+                // Adopt the children only once nothing else can throw; until
+                // then the node is an empty leaf and deletes nothing
+                std::copy(level.data() + c, level.data() + c + k, node->edges.begin());
+                std::fill(level.data() + c, level.data() + c + k, nullptr);
+                node->type = NodeType::INTERNAL;
+                node->n = k - 1;
+                c += k;
+            }
+        } catch (...) {
+            drop(up);
+            drop(level);
+            throw;
+        }
+
+        level = std::move(up);
+        separators = std::move(up_separators);
+    }
+
+    root = level[0];
+}
+
 /* By default, use in-order traversal */
 template<typename T, size_t B>
 void BTree<T, B>::for_all(std::function<void(T&)> func) {
@@ -161,7 +431,7 @@ bool BTreeNode<T, B>::insert(const T& t) {
     // If leaf node
     if (type == NodeType::LEAF) {
         // Shift every key after idx to the right
-        for (int i = n; i >= (int)idx; i--) {
+        for (int i = (int)n - 1; i >= (int)idx; i--) {
             keys[i+1] = keys[i];
         }
 
@@ -190,29 +460,8 @@ bool BTreeNode<T, B>::insert(const T& t) {
  *     n.get_index(31) = 4
  */
 template<typename T, size_t B>
-size_t BTreeNode<T, B>::get_index(const T& t) {
-    // TODO
-    // t is smaller than largest key
-    // for (size_t i = 0; i < n; i++) {
-    //     if (t <= keys[i]) return i;
-    // }
-
-    // // t is greater than largest key
-    // return n;
-
-    // size_t count = 0;
-
-    // for (size_t i = 0; i < n; i++) {
-    //     if (t == keys[i]) return count;
-    //     if (t > keys[i]) count++;
-    // }
-
-    // return count;
-
-    int idx = 0;
-    while (idx < n && keys[idx] < t)
-        ++idx;
-    return idx;
+size_t BTreeNode<T, B>::get_index(const T& t) const {
+    return keys_lower_bound(keys.data(), n, t);
 }
 
 // NOTE: `for_all` and `for_all_nodes` are used internally for testing.
@@ -530,31 +779,24 @@ T& BTreeNode<T, B>::find_rightmost_key(BTreeNode<T, B>& node) {
     return find_rightmost_key(*node.edges[node.n]);
 }
 
-// NOTE: `search` function is originally intended to be used by testing code.
-// Don't modify this function. You can reuse this function 'as-is', or, if
-// you want to do something different, add another function based on this function.
+/* Returns the node holding t and its index there, or { nullptr, -1 }.
+   One get_index per level; only the first n keys of a node are looked at. */
 template<typename T, size_t B>
 std::pair<BTreeNode<T, B>*, size_t>
 BTreeNode<T, B>::search(BTreeNode<T, B>* node, const T& t) {
-    if (node->type == NodeType::LEAF) {
-        for (auto i = 0; i < node->keys.size(); i++)
-            if (t == node->keys[i])
-                return { node, i };
-
-        return { nullptr, -1 };
-    }
+    while (node) {
+        size_t i = node->get_index(t);
 
-    size_t i;
-    for (i = 0; i < node->n; i++) {
-        if (t == node->keys[i])
+        if (i < node->n && node->keys[i] == t)
             return { node, i };
 
-        if (t < node->keys[i]) {
-            return search(node->edges[i], t);
-        }
+        if (node->type == NodeType::LEAF)
+            break;
+
+        node = node->edges[i];
     }
 
-    return search(node->edges[i], t);
+    return { nullptr, -1 };
 }
 
 template<typename T, size_t B>
@@ -579,6 +821,68 @@ std::string BTree<T, B>::format(void) const {
     return root->format_subtree(root->depth());
 }
 
+template<typename T, size_t B>
+bool BTree<T, B>::save_snapshot(const std::string& path) const {
+    static_assert(std::is_trivially_copyable_v<T>, "keys are written as raw bytes");
+
+    constexpr size_t keys_offset = std::max<size_t>(2 * sizeof(uint32_t), alignof(T));
+    constexpr size_t align = std::max<size_t>(alignof(T), alignof(uint32_t));
+    constexpr size_t record_size =
+        (keys_offset + (2 * B - 1) * sizeof(T) + align - 1) / align * align;
+
+    /* Breadth-first numbering; a root with no keys is an empty tree */
+    std::vector<const BTreeNode<T, B>*> order;
+    if (root && root->n > 0)
+        order.push_back(root);
+    for (size_t i = 0; i < order.size(); i++)
+        if (order[i]->type == NodeType::INTERNAL)
+            for (size_t j = 0; j <= order[i]->n; j++)
+                order.push_back(order[i]->edges[j]);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof header.magic);
+    header.key_size = sizeof(T);
+    header.node_keys = 2 * B - 1;
+    header.keys_offset = keys_offset;
+    header.record_size = record_size;
+    header.node_count = order.size();
+
+    std::vector<char> record(record_size);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.seekp(snapshot_page_size);
+
+    uint32_t next_child = 1;
+    for (const BTreeNode<T, B>* node : order) {
+        uint32_t n = node->n;
+        uint32_t first_child = snapshot_leaf;
+
+        if (node->type == NodeType::INTERNAL) {
+            first_child = next_child;
+            next_child += n + 1;
+        }
+
+        std::fill(record.begin(), record.end(), 0);
+        std::memcpy(&record[0], &n, sizeof n);
+        std::memcpy(&record[sizeof n], &first_child, sizeof first_child);
+        std::memcpy(&record[keys_offset], node->keys.data(), n * sizeof(T));
+        out.write(record.data(), record_size);
+
+        header.key_count += n;
+    }
+
+    /* Pad to a whole page, then fill in the header page */
+    size_t end = snapshot_page_size + order.size() * record_size;
+    size_t padded = (end + snapshot_page_size - 1) / snapshot_page_size * snapshot_page_size;
+    std::vector<char> page(snapshot_page_size, 0);
+    out.write(page.data(), padded - end);
+
+    std::memcpy(page.data(), &header, sizeof header);
+    out.seekp(0);
+    out.write(page.data(), snapshot_page_size);
+
+    return (bool)out.flush();
+}
+
 template<typename T, size_t B>
 std::string BTreeNode<T, B>::format_subtree(size_t depth) const {
     std::ostringstream os;
@@ -668,3 +972,292 @@ BTreeNode<T, B>::~BTreeNode() {
     for (auto i = 0; i < n + 1; i++)
         if (edges[i]) delete edges[i];
 }
+
+/* B+tree: every key lives in a leaf, internal nodes only hold copies of
+ * keys as separators, and the leaves are chained left to right through
+ * `next`. A range scan descends once to its first key and then walks
+ * the leaf chain, never going back up the tree. Keys in edges[i] are
+ * >= keys[i - 1] and < keys[i]. Nodes are split on the way down, as in
+ * BTree::insert. */
+template<typename T, size_t B = 6>
+struct BPlusNode {
+    NodeType type;
+    size_t n;
+    std::array<T, 2 * B - 1> keys;
+    std::array<BPlusNode *, 2 * B> edges;
+    BPlusNode* next;    // next leaf in key order; leaves only
+
+    BPlusNode();
+    ~BPlusNode();
+
+    size_t get_index(const T& t) const;
+    size_t child_index(const T& t) const;
+
+    static void split_child(BPlusNode<T, B>&, size_t);
+};
+
+template<typename T, size_t B = 6>
+struct BPlusTree {
+    BPlusNode<T, B>* root = nullptr;
+
+    struct const_iterator;
+    struct Range;
+
+    ~BPlusTree() { if (root) delete root; }
+
+    bool insert(const T&);
+    bool contains(const T&) const;
+
+    // Keys in [lo, hi), in order
+    Range range(const T& lo, const T& hi) const;
+
+    const_iterator begin() const;
+    const_iterator end() const { return const_iterator{}; }
+
+    void for_all(std::function<void(const T&)>) const;
+    const std::optional<size_t> depth() const;
+
+    const BPlusNode<T, B>* find_leaf(const T& t) const;
+};
+
+/* Forward iterator over the leaf chain. It stops at the first key that
+   is not below `hi`, or after the last leaf when there is no `hi`. */
+template<typename T, size_t B>
+struct BPlusTree<T, B>::const_iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const BPlusNode<T, B>* leaf = nullptr;
+    size_t idx = 0;
+    std::optional<T> hi;    // upper bound of a range scan; unset for an unbounded one
+
+    reference operator*() const { return leaf->keys[idx]; }
+    pointer operator->() const { return &leaf->keys[idx]; }
+
+    const_iterator& operator++() {
+        if (++idx == leaf->n) {
+            leaf = leaf->next;
+            idx = 0;
+
+            // Leaves are scattered on the heap; start loading the one
+            // after this while its keys are consumed
+            if (leaf && leaf->next)
+                __builtin_prefetch(leaf->next);
+        }
+        check_bound();
+        return *this;
+    }
+
+    const_iterator operator++(int) {
+        const_iterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    bool operator==(const const_iterator& o) const { return leaf == o.leaf && idx == o.idx; }
+    bool operator!=(const const_iterator& o) const { return !(*this == o); }
+
+    // Turn into end() once past the bound
+    void check_bound() {
+        if (leaf && hi && !(leaf->keys[idx] < *hi)) {
+            leaf = nullptr;
+            idx = 0;
+        }
+    }
+};
+
+template<typename T, size_t B>
+struct BPlusTree<T, B>::Range {
+    const_iterator first;
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return const_iterator{}; }
+};
+
+template<typename T, size_t B>
+BPlusNode<T, B>::BPlusNode() : type(NodeType::LEAF), n(0), next(nullptr) {}
+
+template<typename T, size_t B>
+BPlusNode<T, B>::~BPlusNode() {
+    if (type == NodeType::LEAF)
+        return;
+
+    for (size_t i = 0; i < n + 1; i++)
+        if (edges[i]) delete edges[i];
+}
+
+template<typename T, size_t B>
+size_t BPlusNode<T, B>::get_index(const T& t) const {
+    return keys_lower_bound(keys.data(), n, t);
+}
+
+/* The edge to follow from an internal node: a key equal to a separator
+   lives in the right subtree */
+template<typename T, size_t B>
+size_t BPlusNode<T, B>::child_index(const T& t) const {
+    size_t i = get_index(t);
+
+    if (i < n && keys[i] == t)
+        i++;
+
+    return i;
+}
+
+/* Assume parent.edges[idx] is full and the parent is not. A leaf keeps
+   its first B keys and the first key of the new right leaf is copied up;
+   an internal node moves its middle key up, as in a B-tree. */
+template<typename T, size_t B>
+void BPlusNode<T, B>::split_child(BPlusNode<T, B>& parent, size_t idx) {
+    BPlusNode<T, B>* child = parent.edges[idx];
+    BPlusNode<T, B>* sibling = new BPlusNode<T, B>();
+    sibling->type = child->type;
+
+    T separator;
+
+    if (child->type == NodeType::LEAF) {
+        for (size_t i = B; i < child->n; i++)
+            sibling->keys[i - B] = child->keys[i];
+
+        sibling->n = child->n - B;
+        child->n = B;
+
+        sibling->next = child->next;
+        child->next = sibling;
+
+        separator = sibling->keys[0];
+    } else {
+        for (size_t i = B; i < child->n; i++)
+            sibling->keys[i - B] = child->keys[i];
+        for (size_t i = B; i <= child->n; i++)
+            sibling->edges[i - B] = child->edges[i];
+
+        separator = child->keys[B - 1];
+        sibling->n = child->n - B;
+        child->n = B - 1;
+    }
+
+    for (size_t i = parent.n; i > idx; i--)
+        parent.keys[i] = parent.keys[i - 1];
+    for (size_t i = parent.n + 1; i > idx + 1; i--)
+        parent.edges[i] = parent.edges[i - 1];
+
+    parent.keys[idx] = separator;
+    parent.edges[idx + 1] = sibling;
+    parent.n++;
+    parent.type = NodeType::INTERNAL;
+}
+
+template<typename T, size_t B>
+bool BPlusTree<T, B>::insert(const T& t) {
+    if (!root)
+        root = new BPlusNode<T, B>();
+
+    if (root->n >= 2 * B - 1) {
+        BPlusNode<T, B>* new_root = new BPlusNode<T, B>();
+        new_root->edges[0] = root;
+        BPlusNode<T, B>::split_child(*new_root, 0);
+        root = new_root;
+    }
+
+    BPlusNode<T, B>* node = root;
+
+    while (node->type == NodeType::INTERNAL) {
+        size_t i = node->child_index(t);
+
+        if (node->edges[i]->n >= 2 * B - 1) {
+            BPlusNode<T, B>::split_child(*node, i);
+            i = node->child_index(t);
+        }
+
+        node = node->edges[i];
+    }
+
+    size_t idx = node->get_index(t);
+
+    if (idx < node->n && node->keys[idx] == t)
+        return false;
+
+    for (size_t i = node->n; i > idx; i--)
+        node->keys[i] = node->keys[i - 1];
+
+    node->keys[idx] = t;
+    node->n++;
+
+    return true;
+}
+
+/* The leaf whose key range covers t */
+template<typename T, size_t B>
+const BPlusNode<T, B>* BPlusTree<T, B>::find_leaf(const T& t) const {
+    const BPlusNode<T, B>* node = root;
+
+    while (node && node->type == NodeType::INTERNAL)
+        node = node->edges[node->child_index(t)];
+
+    return node;
+}
+
+template<typename T, size_t B>
+bool BPlusTree<T, B>::contains(const T& t) const {
+    const BPlusNode<T, B>* leaf = find_leaf(t);
+
+    if (!leaf)
+        return false;
+
+    size_t idx = leaf->get_index(t);
+    return idx < leaf->n && leaf->keys[idx] == t;
+}
+
+template<typename T, size_t B>
+typename BPlusTree<T, B>::Range BPlusTree<T, B>::range(const T& lo, const T& hi) const {
+    const_iterator it;
+    it.leaf = find_leaf(lo);
+    it.hi = hi;
+
+    if (it.leaf) {
+        it.idx = it.leaf->get_index(lo);
+
+        // Every key of this leaf is below lo; start at the next one
+        if (it.idx == it.leaf->n) {
+            it.leaf = it.leaf->next;
+            it.idx = 0;
+        }
+    }
+
+    it.check_bound();
+    return Range{ it };
+}
+
+template<typename T, size_t B>
+typename BPlusTree<T, B>::const_iterator BPlusTree<T, B>::begin() const {
+    const BPlusNode<T, B>* node = root;
+
+    while (node && node->type == NodeType::INTERNAL)
+        node = node->edges[0];
+
+    const_iterator it;
+    it.leaf = (node && node->n > 0) ? node : nullptr;
+    return it;
+}
+
+/* In-order, leaf by leaf */
+template<typename T, size_t B>
+void BPlusTree<T, B>::for_all(std::function<void(const T&)> func) const {
+    for (const T& t : *this)
+        func(t);
+}
+
+template<typename T, size_t B>
+const std::optional<size_t> BPlusTree<T, B>::depth() const {
+    if (!root)
+        return std::nullopt;
+
+    size_t d = 0;
+    for (const BPlusNode<T, B>* node = root; node->type == NodeType::INTERNAL; node = node->edges[0])
+        d++;
+
+    return d;
+}
@@ -0,0 +1,503 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "btree.hpp"
+
+/* Fixed-size page cache over one file. Frames are page aligned and
+ * replaced with the CLOCK policy: every access sets a frame's reference
+ * bit, and the hand clears bits as it sweeps until it finds an unpinned
+ * frame whose bit is already clear. Dirty frames are written back when
+ * evicted or flushed. I/O failures throw std::system_error. */
+template<size_t PageSize = 4096>
+struct BufferPool {
+    struct Frame {
+        uint32_t page_id = 0;   // 0: frame is free (page 0 is never cached)
+        uint32_t pins = 0;
+        bool dirty = false;
+        bool referenced = false;
+    };
+
+    int fd;
+    char* memory;
+    std::vector<Frame> frames;
+    std::unordered_map<uint32_t, size_t> page_table;
+    size_t hand = 0;
+
+    size_t hits = 0, misses = 0, writes = 0;
+
+    BufferPool(int fd, size_t num_frames);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Pin the page and return its frame. A `fresh` page is zero filled
+    // instead of read, for pages that were just allocated.
+    size_t pin(uint32_t page_id, bool fresh = false);
+    void unpin(size_t frame, bool dirty);
+
+    char* data(size_t frame) { return memory + frame * PageSize; }
+
+    void flush_all();
+
+    size_t find_victim();
+    void write_back(size_t frame);
+};
+
+template<size_t PageSize>
+BufferPool<PageSize>::BufferPool(int fd, size_t num_frames)
+    : fd(fd), frames(num_frames) {
+    memory = static_cast<char*>(std::aligned_alloc(PageSize, num_frames * PageSize));
+    if (!memory)
+        throw std::bad_alloc();
+}
+
+template<size_t PageSize>
+BufferPool<PageSize>::~BufferPool() {
+    std::free(memory);
+}
+
+template<size_t PageSize>
+size_t BufferPool<PageSize>::pin(uint32_t page_id, bool fresh) {
+    auto it = page_table.find(page_id);
+
+    if (it != page_table.end()) {
+        Frame& f = frames[it->second];
+        f.pins++;
+        f.referenced = true;
+        hits++;
+        return it->second;
+    }
+
+    misses++;
+    size_t frame = find_victim();
+    Frame& f = frames[frame];
+
+    if (f.page_id != 0) {
+        if (f.dirty)
+            write_back(frame);
+        page_table.erase(f.page_id);
+
+        // The old page is gone; if the read below fails the frame must
+        // be free, not still claim a page it no longer maps
+        f = Frame{};
+    }
+
+    if (fresh) {
+        std::memset(data(frame), 0, PageSize);
+    } else {
+        ssize_t got = pread(fd, data(frame), PageSize, (off_t)page_id * PageSize);
+        if (got != (ssize_t)PageSize)
+            throw std::system_error(got < 0 ? errno : EIO, std::generic_category(), "pread");
+    }
+
+    f = Frame{ page_id, 1, fresh, true };
+    page_table.emplace(page_id, frame);
+
+    return frame;
+}
+
+template<size_t PageSize>
+void BufferPool<PageSize>::unpin(size_t frame, bool dirty) {
+    frames[frame].pins--;
+    frames[frame].dirty |= dirty;
+}
+
+template<size_t PageSize>
+size_t BufferPool<PageSize>::find_victim() {
+    // One sweep clears every reference bit, so finding nothing in two
+    // means every frame is pinned
+    for (size_t step = 0; step < 2 * frames.size(); step++) {
+        size_t frame = hand;
+        hand = (hand + 1) % frames.size();
+
+        Frame& f = frames[frame];
+        if (f.pins > 0)
+            continue;
+        if (f.referenced) {
+            f.referenced = false;
+            continue;
+        }
+
+        return frame;
+    }
+
+    throw std::runtime_error("BufferPool: every frame is pinned");
+}
+
+template<size_t PageSize>
+void BufferPool<PageSize>::write_back(size_t frame) {
+    Frame& f = frames[frame];
+    ssize_t put = pwrite(fd, data(frame), PageSize, (off_t)f.page_id * PageSize);
+
+    if (put != (ssize_t)PageSize)
+        throw std::system_error(put < 0 ? errno : EIO, std::generic_category(), "pwrite");
+
+    f.dirty = false;
+    writes++;
+}
+
+template<size_t PageSize>
+void BufferPool<PageSize>::flush_all() {
+    for (size_t frame = 0; frame < frames.size(); frame++)
+        if (frames[frame].page_id != 0 && frames[frame].dirty)
+            write_back(frame);
+}
+
+/* One B-tree node per page. B is derived from the key size so that a
+   node fills the page: 255 for 4-byte keys in 4 KiB pages. */
+template<typename T, size_t PageSize>
+struct DiskPage {
+    static constexpr size_t B =
+        (PageSize - 2 * sizeof(uint32_t) - alignof(T)) / (2 * (sizeof(T) + sizeof(uint32_t)));
+
+    NodeType type;
+    uint32_t n;
+    T keys[2 * B - 1];
+    uint32_t edges[2 * B];  // child page ids
+};
+
+/* B-tree stored in a single file of PageSize pages, read and written
+ * through a BufferPool, so it can outgrow memory and survives restarts.
+ * Page 0 holds the metadata and every other page one node; child edges
+ * are page ids. Keys must be trivially copyable since pages are written
+ * as raw bytes. Insertion splits full nodes on the way down, as in
+ * BTree::insert; duplicates are rejected. There is no removal.
+ *
+ * Changes reach the file when pages are evicted and on flush() or
+ * close(); only a flushed file is guaranteed to reopen consistently. */
+template<typename T, size_t PageSize = 4096>
+struct DiskBTree {
+    static_assert(std::is_trivially_copyable_v<T>, "keys are stored as raw bytes");
+
+    using Page = DiskPage<T, PageSize>;
+    static constexpr size_t B = Page::B;
+    static_assert(B >= 2, "page too small for this key type");
+    static_assert(sizeof(Page) <= PageSize);
+
+    struct Meta {
+        char magic[8];
+        uint32_t page_size;
+        uint32_t key_size;
+        uint32_t root;          // 0: empty tree
+        uint32_t page_count;    // including this one
+        uint64_t count;         // number of keys
+    };
+
+    /* A pinned page, unpinned when the reference goes away */
+    struct PageRef {
+        BufferPool<PageSize>* pool = nullptr;
+        size_t frame = 0;
+        uint32_t id = 0;
+        bool dirty = false;
+
+        PageRef() = default;
+        PageRef(BufferPool<PageSize>* pool, uint32_t id, bool fresh)
+            : pool(pool), frame(pool->pin(id, fresh)), id(id), dirty(fresh) {}
+        PageRef(PageRef&& o) noexcept { *this = std::move(o); }
+        PageRef& operator=(PageRef&& o) noexcept {
+            release();
+            pool = std::exchange(o.pool, nullptr);
+            frame = o.frame;
+            id = o.id;
+            dirty = o.dirty;
+            return *this;
+        }
+        ~PageRef() { release(); }
+
+        void release() {
+            if (pool) pool->unpin(frame, dirty);
+            pool = nullptr;
+        }
+
+        Page* operator->() const { return reinterpret_cast<Page*>(pool->data(frame)); }
+    };
+
+    int fd = -1;
+    Meta meta{};
+    std::unique_ptr<BufferPool<PageSize>> pool;
+
+    DiskBTree() = default;
+
+    // Best effort, as for std::fstream: a destructor must not throw, so
+    // a failed final flush is dropped here. Call close() to see it.
+    ~DiskBTree() {
+        try { close(); } catch (...) {}
+    }
+
+    DiskBTree(const DiskBTree&) = delete;
+    DiskBTree& operator=(const DiskBTree&) = delete;
+
+    // Open or create the file at `path` with a pool of `pool_pages`
+    // pages (at least 8). Returns false if the file cannot be opened or
+    // was written with another page or key size.
+    bool open(const std::string& path, size_t pool_pages = 1024);
+    void flush();
+    // Flush and close the file. The file is closed even if the flush
+    // throws; the error is then rethrown.
+    void close();
+    bool is_open() const { return fd >= 0; }
+
+    bool insert(const T&);
+    bool contains(const T&);
+
+    void for_all(std::function<void(const T&)>);
+    const std::optional<size_t> depth();
+
+    size_t size() const { return meta.count; }
+    size_t page_count() const { return meta.page_count; }
+
+    PageRef fetch(uint32_t id) { return PageRef(pool.get(), id, false); }
+    PageRef allocate();
+
+    void split_child(PageRef& parent, size_t idx, PageRef& child);
+    void for_all(uint32_t id, const std::function<void(const T&)>& func);
+    void release();
+};
+
+inline constexpr char disk_btree_magic[8] = { 'B', 'T', 'R', 'E', 'E', 'P', 'G', '1' };
+
+template<typename T, size_t PageSize>
+bool DiskBTree<T, PageSize>::open(const std::string& path, size_t pool_pages) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    if (st.st_size == 0) {
+        std::memcpy(meta.magic, disk_btree_magic, sizeof meta.magic);
+        meta.page_size = PageSize;
+        meta.key_size = sizeof(T);
+        meta.root = 0;
+        meta.page_count = 1;
+        meta.count = 0;
+    } else if (pread(fd, &meta, sizeof meta, 0) != (ssize_t)sizeof meta ||
+               std::memcmp(meta.magic, disk_btree_magic, sizeof meta.magic) != 0 ||
+               meta.page_size != PageSize || meta.key_size != sizeof(T)) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    pool = std::make_unique<BufferPool<PageSize>>(fd, std::max<size_t>(pool_pages, 8));
+    return true;
+}
+
+/* Write every dirty page and then the metadata, and sync the file */
+template<typename T, size_t PageSize>
+void DiskBTree<T, PageSize>::flush() {
+    if (fd < 0)
+        return;
+
+    pool->flush_all();
+
+    std::vector<char> page(PageSize);
+    std::memcpy(page.data(), &meta, sizeof meta);
+
+    if (pwrite(fd, page.data(), PageSize, 0) != (ssize_t)PageSize)
+        throw std::system_error(errno, std::generic_category(), "pwrite");
+    if (fdatasync(fd) != 0)
+        throw std::system_error(errno, std::generic_category(), "fdatasync");
+}
+
+template<typename T, size_t PageSize>
+void DiskBTree<T, PageSize>::close() {
+    if (fd < 0)
+        return;
+
+    try {
+        flush();
+    } catch (...) {
+        release();
+        throw;
+    }
+
+    release();
+}
+
+/* Drop the pool and the descriptor without writing anything */
+template<typename T, size_t PageSize>
+void DiskBTree<T, PageSize>::release() {
+    pool.reset();
+    ::close(fd);
+    fd = -1;
+}
+
+/* The page id is only taken once the pin succeeds, so a failed pin
+   does not leave a hole in the file */
+template<typename T, size_t PageSize>
+typename DiskBTree<T, PageSize>::PageRef DiskBTree<T, PageSize>::allocate() {
+    PageRef page(pool.get(), meta.page_count, true);
+    meta.page_count++;
+    return page;
+}
+
+/* Same shape as BTreeNode::split_child: the middle key moves up and the
+   upper half goes to a new page */
+template<typename T, size_t PageSize>
+void DiskBTree<T, PageSize>::split_child(PageRef& parent, size_t idx, PageRef& child) {
+    PageRef sibling = allocate();
+    sibling->type = child->type;
+
+    for (size_t i = B; i < 2 * B - 1; i++)
+        sibling->keys[i - B] = child->keys[i];
+    if (child->type == NodeType::INTERNAL)
+        for (size_t i = B; i < 2 * B; i++)
+            sibling->edges[i - B] = child->edges[i];
+
+    for (size_t i = parent->n; i > idx; i--)
+        parent->keys[i] = parent->keys[i - 1];
+    for (size_t i = parent->n + 1; i > idx + 1; i--)
+        parent->edges[i] = parent->edges[i - 1];
+
+    parent->keys[idx] = child->keys[B - 1];
+    parent->edges[idx + 1] = sibling.id;
+    parent->n++;
+
+    child->n = B - 1;
+    sibling->n = B - 1;
+
+    parent.dirty = child.dirty = true;
+}
+
+template<typename T, size_t PageSize>
+bool DiskBTree<T, PageSize>::insert(const T& t) {
+    if (meta.root == 0) {
+        PageRef root = allocate();
+        root->type = NodeType::LEAF;
+        root->n = 1;
+        root->keys[0] = t;
+
+        meta.root = root.id;
+        meta.count++;
+        return true;
+    }
+
+    PageRef node = fetch(meta.root);
+
+    if (node->n == 2 * B - 1) {
+        PageRef new_root = allocate();
+        new_root->type = NodeType::INTERNAL;
+        new_root->n = 0;
+        new_root->edges[0] = node.id;
+
+        split_child(new_root, 0, node);
+        meta.root = new_root.id;
+        node = std::move(new_root);
+    }
+
+    while (node->type == NodeType::INTERNAL) {
+        size_t i = keys_lower_bound(node->keys, node->n, t);
+
+        if (i < node->n && node->keys[i] == t)
+            return false;
+
+        PageRef child = fetch(node->edges[i]);
+
+        if (child->n == 2 * B - 1) {
+            split_child(node, i, child);
+
+            if (node->keys[i] == t)
+                return false;
+            if (node->keys[i] < t)
+                child = fetch(node->edges[i + 1]);
+        }
+
+        node = std::move(child);
+    }
+
+    size_t idx = keys_lower_bound(node->keys, node->n, t);
+
+    if (idx < node->n && node->keys[idx] == t)
+        return false;
+
+    for (size_t i = node->n; i > idx; i--)
+        node->keys[i] = node->keys[i - 1];
+
+    node->keys[idx] = t;
+    node->n++;
+    node.dirty = true;
+    meta.count++;
+
+    return true;
+}
+
+template<typename T, size_t PageSize>
+bool DiskBTree<T, PageSize>::contains(const T& t) {
+    uint32_t id = meta.root;
+
+    while (id != 0) {
+        PageRef node = fetch(id);
+        size_t i = keys_lower_bound(node->keys, node->n, t);
+
+        if (i < node->n && node->keys[i] == t)
+            return true;
+        if (node->type == NodeType::LEAF)
+            return false;
+
+        id = node->edges[i];
+    }
+
+    return false;
+}
+
+/* In-order; keeps one page pinned per level */
+template<typename T, size_t PageSize>
+void DiskBTree<T, PageSize>::for_all(std::function<void(const T&)> func) {
+    if (meta.root != 0)
+        for_all(meta.root, func);
+}
+
+template<typename T, size_t PageSize>
+void DiskBTree<T, PageSize>::for_all(uint32_t id, const std::function<void(const T&)>& func) {
+    PageRef node = fetch(id);
+
+    for (size_t i = 0; i < node->n; i++) {
+        if (node->type == NodeType::INTERNAL)
+            for_all(node->edges[i], func);
+        func(node->keys[i]);
+    }
+
+    if (node->type == NodeType::INTERNAL)
+        for_all(node->edges[node->n], func);
+}
+
+template<typename T, size_t PageSize>
+const std::optional<size_t> DiskBTree<T, PageSize>::depth() {
+    if (meta.root == 0)
+        return std::nullopt;
+
+    size_t d = 0;
+    for (PageRef node = fetch(meta.root); node->type == NodeType::INTERNAL;
+         node = fetch(node->edges[0]))
+        d++;
+
+    return d;
+}
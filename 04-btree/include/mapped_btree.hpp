@@ -0,0 +1,280 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "btree.hpp"
+
+/* Read-only B-tree served straight from a file written by
+ * BTree::save_snapshot. open() maps the file and checks the header;
+ * nothing is deserialized, and the kernel pages nodes in as queries
+ * touch them, so a large snapshot is ready as soon as it is mapped.
+ * The node size comes from the file, so any B can be opened.
+ *
+ * open() checks the header and the record layout against the file
+ * size. Records are only checked as queries reach them, so a corrupt
+ * node can give wrong answers but never a read outside the mapping: key
+ * counts are capped at the node size, and a child link that is out of
+ * range or does not point forward in breadth-first order ends the
+ * descent as if the node were a leaf. */
+template<typename T>
+class MappedBTree
+{
+    public:
+        class const_iterator;
+
+        MappedBTree() = default;
+        ~MappedBTree() { close(); }
+
+        MappedBTree(const MappedBTree&) = delete;
+        MappedBTree& operator=(const MappedBTree&) = delete;
+
+        // Returns false if the file cannot be mapped or was not written
+        // by save_snapshot for this key type
+        bool open(const std::string& path);
+        void close();
+        bool is_open() const { return base != nullptr; }
+
+        size_t size() const { return header().key_count; }
+
+        bool contains(const T& t) const { return find(t) != nullptr; }
+
+        // The stored key equal to t, inside the mapping, or nullptr
+        const T* find(const T& t) const;
+
+        const_iterator begin() const;
+        const_iterator end() const { return const_iterator(this); }
+        const_iterator lower_bound(const T& t) const;
+
+        // Call f(key) for every key in [lo, hi), in order
+        template <typename F>
+        void for_each_in_range(const T& lo, const T& hi, F&& f) const;
+
+    private:
+        const char* base = nullptr;
+        size_t length = 0;
+
+        const SnapshotHeader& header() const {
+            return *reinterpret_cast<const SnapshotHeader*>(base);
+        }
+
+        const char* record(uint32_t i) const {
+            return base + snapshot_page_size + (size_t)i * header().record_size;
+        }
+        uint32_t key_count(uint32_t i) const {
+            uint32_t n;
+            std::memcpy(&n, record(i), sizeof n);
+            return std::min(n, header().node_keys);
+        }
+        // Record of edge e of node i, or snapshot_leaf if there is none
+        uint32_t child(uint32_t i, uint32_t e) const {
+            uint32_t c;
+            std::memcpy(&c, record(i) + sizeof(uint32_t), sizeof c);
+
+            if (c == snapshot_leaf || c <= i || (uint64_t)c + e >= header().node_count)
+                return snapshot_leaf;
+            return c + e;
+        }
+        const T* keys(uint32_t i) const {
+            return reinterpret_cast<const T*>(record(i) + header().keys_offset);
+        }
+};
+
+/* In-order iterator. It keeps the path from the root as (record, index)
+ * pairs: the top one names the current key, and each one below it the
+ * key to visit once its child at that index is done. */
+template<typename T>
+class MappedBTree<T>::const_iterator
+{
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        reference operator*() const { return tree->keys(path[depth - 1].first)[path[depth - 1].second]; }
+        pointer operator->() const { return &**this; }
+
+        const_iterator& operator++() {
+            auto& [node, i] = path[depth - 1];
+
+            // The next key is the leftmost one under edge i + 1, if any
+            i++;
+            uint32_t child = tree->child(node, i);
+            if (child != snapshot_leaf)
+                push_leftmost(child);
+
+            settle();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& o) const {
+            if (depth != o.depth) return false;
+            return depth == 0 || path[depth - 1] == o.path[depth - 1];
+        }
+        bool operator!=(const const_iterator& o) const { return !(*this == o); }
+
+    private:
+        friend class MappedBTree<T>;
+
+        // Enough for 2^32 keys at the smallest B; a deeper path can only
+        // come from a corrupt file, and is cut off there
+        static constexpr size_t max_depth = 40;
+
+        const MappedBTree<T>* tree = nullptr;
+        std::array<std::pair<uint32_t, uint32_t>, max_depth> path;
+        size_t depth = 0;
+
+        explicit const_iterator(const MappedBTree<T>* tree) : tree(tree) {}
+
+        void push_leftmost(uint32_t node) {
+            while (depth < max_depth && node != snapshot_leaf) {
+                path[depth++] = { node, 0 };
+                node = tree->child(node, 0);
+            }
+        }
+
+        // Pop finished nodes until the top names a key, or the path is empty
+        void settle() {
+            while (depth > 0 && path[depth - 1].second == tree->key_count(path[depth - 1].first))
+                depth--;
+        }
+};
+
+template<typename T>
+bool MappedBTree<T>::open(const std::string& path) {
+    static_assert(std::is_trivially_copyable_v<T>, "keys are read as raw bytes");
+
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < snapshot_page_size) {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);    // the mapping keeps the file alive
+
+    if (map == MAP_FAILED)
+        return false;
+
+    base = static_cast<const char*>(map);
+    length = st.st_size;
+
+    /* Every record must hold its two links and node_keys keys, and all
+       node_count of them must lie inside the file */
+    const SnapshotHeader& h = header();
+    if (std::memcmp(h.magic, snapshot_magic, sizeof h.magic) != 0 ||
+        h.key_size != sizeof(T) || h.node_keys == 0 ||
+        h.keys_offset < 2 * sizeof(uint32_t) || h.keys_offset % alignof(T) != 0 ||
+        h.record_size % alignof(T) != 0 ||
+        (uint64_t)h.keys_offset + (uint64_t)h.node_keys * sizeof(T) > h.record_size ||
+        h.node_count >= snapshot_leaf ||
+        h.node_count > (length - snapshot_page_size) / h.record_size) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+template<typename T>
+void MappedBTree<T>::close() {
+    if (base)
+        munmap(const_cast<char*>(base), length);
+
+    base = nullptr;
+    length = 0;
+}
+
+template<typename T>
+const T* MappedBTree<T>::find(const T& t) const {
+    if (!base || header().node_count == 0)
+        return nullptr;
+
+    uint32_t node = 0;
+
+    for (;;) {
+        const T* k = keys(node);
+        uint32_t n = key_count(node);
+        size_t i = keys_lower_bound(k, n, t);
+
+        if (i < n && k[i] == t)
+            return &k[i];
+
+        node = child(node, i);
+        if (node == snapshot_leaf)
+            return nullptr;
+    }
+}
+
+template<typename T>
+typename MappedBTree<T>::const_iterator MappedBTree<T>::begin() const {
+    const_iterator it(this);
+
+    if (base && header().node_count > 0) {
+        it.push_leftmost(0);
+        it.settle();
+    }
+
+    return it;
+}
+
+template<typename T>
+typename MappedBTree<T>::const_iterator MappedBTree<T>::lower_bound(const T& t) const {
+    const_iterator it(this);
+
+    if (!base || header().node_count == 0)
+        return it;
+
+    uint32_t node = 0;
+
+    while (it.depth < const_iterator::max_depth) {
+        const T* k = keys(node);
+        uint32_t n = key_count(node);
+        uint32_t i = keys_lower_bound(k, n, t);
+
+        it.path[it.depth++] = { node, i };
+
+        if (i < n && k[i] == t)
+            break;
+
+        node = child(node, i);
+        if (node == snapshot_leaf)
+            break;
+    }
+
+    it.settle();
+    return it;
+}
+
+template<typename T>
+template<typename F>
+void MappedBTree<T>::for_each_in_range(const T& lo, const T& hi, F&& f) const {
+    for (auto it = lower_bound(lo), last = end(); it != last && *it < hi; ++it)
+        f(*it);
+}
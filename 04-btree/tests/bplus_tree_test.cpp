@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <random>
+#include <numeric>
+
+#include "btree.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+/* Every leaf at the same depth, chained in order, and every node between
+   B-1 and 2B-1 keys except the root */
+template<typename T, size_t B>
+static size_t check_node(const BPlusNode<T, B>* node, size_t depth,
+                         std::vector<const BPlusNode<T, B>*>& leaves, bool is_root) {
+    if (!is_root)
+        REQUIRE(node->n >= B - 1);
+    REQUIRE(node->n <= 2 * B - 1);
+    REQUIRE(std::is_sorted(node->keys.begin(), node->keys.begin() + node->n));
+
+    if (node->type == NodeType::LEAF) {
+        leaves.push_back(node);
+        return depth;
+    }
+
+    size_t d = check_node(node->edges[0], depth + 1, leaves, false);
+    for (size_t i = 1; i <= node->n; i++) {
+        /* The separator bounds both neighbours */
+        const BPlusNode<T, B>* left = node->edges[i - 1];
+        const BPlusNode<T, B>* right = node->edges[i];
+        REQUIRE(left->keys[left->n - 1] < node->keys[i - 1]);
+        REQUIRE(!(right->keys[0] < node->keys[i - 1]));
+        REQUIRE(check_node(right, depth + 1, leaves, false) == d);
+    }
+
+    return d;
+}
+
+TEST_CASE("B+tree insert, contains and leaf chain", "[bplus]") {
+    static constexpr size_t B = 3;
+    BPlusTree<int, B> tree;
+    std::vector<int> xs;
+    size_t N = 50'000;
+
+    std::mt19937 g(11);
+
+    for (size_t i = 0; i < N; i++)
+        xs.push_back(2 * (int)i);
+
+    std::shuffle(xs.begin(), xs.end(), g);
+
+    for (auto x : xs)
+        REQUIRE(tree.insert(x) == true);
+    REQUIRE(tree.insert(xs[0]) == false);
+
+    std::vector<const BPlusNode<int, B>*> leaves;
+    size_t depth = check_node(tree.root, 0, leaves, true);
+    REQUIRE(tree.depth().value() == depth);
+
+    /* The chain links the leaves in tree order */
+    for (size_t i = 0; i + 1 < leaves.size(); i++)
+        REQUIRE(leaves[i]->next == leaves[i + 1]);
+    REQUIRE(leaves.back()->next == nullptr);
+
+    std::vector<int> ys(tree.begin(), tree.end());
+    std::sort(xs.begin(), xs.end());
+    REQUIRE(ys == xs);
+
+    for (auto i = -1; i <= 2 * (int)N; i++)
+        REQUIRE(tree.contains(i) == (i >= 0 && i % 2 == 0 && i < 2 * (int)N));
+}
+
+TEST_CASE("B+tree range scans", "[bplus]") {
+    BPlusTree<int, 8> tree;
+    std::vector<int> xs(20'000);
+
+    std::iota(xs.begin(), xs.end(), 0);
+    std::transform(xs.begin(), xs.end(), xs.begin(), [](int x) { return 3 * x; });
+
+    std::mt19937 g(5);
+    std::vector<int> shuffled = xs;
+    std::shuffle(shuffled.begin(), shuffled.end(), g);
+    for (auto x : shuffled)
+        tree.insert(x);
+
+    for (auto i = 0; i < 500; i++) {
+        int lo = (int)(g() % 61'000) - 500;
+        int hi = lo + (int)(g() % 5'000);
+
+        auto r = tree.range(lo, hi);
+        std::vector<int> got(r.begin(), r.end());
+        REQUIRE(got == std::vector<int>(std::lower_bound(xs.begin(), xs.end(), lo),
+                                        std::lower_bound(xs.begin(), xs.end(), hi)));
+    }
+
+    /* Empty, inverted and whole-tree ranges */
+    auto empty = tree.range(10, 10);
+    REQUIRE(empty.begin() == empty.end());
+    auto inverted = tree.range(90, 30);
+    REQUIRE(inverted.begin() == inverted.end());
+    auto all = tree.range(-1, 1 << 30);
+    REQUIRE(std::distance(all.begin(), all.end()) == (long)xs.size());
+
+    std::vector<int> visited;
+    tree.for_all([&](const int& x) { visited.push_back(x); });
+    REQUIRE(visited == xs);
+
+    BPlusTree<int, 8> none;
+    REQUIRE(none.begin() == none.end());
+    REQUIRE(none.range(0, 10).begin() == none.end());
+    REQUIRE(none.contains(0) == false);
+}
@@ -1,7 +1,15 @@
 #include <algorithm>
+#include <numeric>
 #include <iterator>
 #include <vector>
 #include <random>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <climits>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 
 #include "btree.hpp"
 
@@ -156,3 +164,280 @@ TEST_CASE("Perfect balance") {
                             return n->type == NodeType::LEAF;
                         }));
 }
+
+/* get_index must agree with std::lower_bound over the live keys, whatever
+   the stale slots past n contain */
+template<typename T, size_t B>
+static void check_get_index(std::vector<T> sorted, const std::vector<T>& probes) {
+    sorted.resize(std::min(sorted.size(), 2 * B - 1));
+
+    for (size_t n = 0; n <= sorted.size(); n++) {
+        BTreeNode<T, B> node(sorted.begin(), sorted.end());
+        node.n = n;
+
+        for (const T& p : probes) {
+            size_t expected =
+                std::lower_bound(sorted.begin(), sorted.begin() + n, p) - sorted.begin();
+            REQUIRE(node.get_index(p) == expected);
+        }
+    }
+}
+
+TEST_CASE("get_index over SIMD and branchless paths", "[btree]") {
+    std::vector<int> ints, int_probes;
+    std::vector<int64_t> longs, long_probes;
+    std::vector<double> doubles, double_probes;
+    std::vector<std::string> strings, string_probes;
+
+    for (int i = 0; i < 127; i++) {
+        ints.push_back(2 * i - 100);
+        longs.push_back((int64_t)(2 * i) << 40);
+        doubles.push_back(0.5 * i);
+        strings.push_back("k" + std::to_string(1000 + 2 * i));
+    }
+    for (int i = -1; i < 256; i++) {
+        int_probes.push_back(i - 100);
+        long_probes.push_back((int64_t)i * ((int64_t)1 << 40));
+        double_probes.push_back(0.25 * i);
+        string_probes.push_back("k" + std::to_string(999 + i));
+    }
+
+    check_get_index<int, 2>(ints, int_probes);
+    check_get_index<int, 9>(ints, int_probes);
+    check_get_index<int, 64>(ints, int_probes);
+    check_get_index<int64_t, 5>(longs, long_probes);
+    check_get_index<int64_t, 64>(longs, long_probes);
+    check_get_index<double, 17>(doubles, double_probes);
+    check_get_index<std::string, 2>(strings, string_probes);
+    check_get_index<std::string, 33>(strings, string_probes);
+}
+
+/* Byte-wide keys in a very wide node: each SIMD lane counts more than
+   127 matches, more than a byte-wide lane can hold */
+template<typename T>
+static void check_wide_byte_node() {
+    static constexpr size_t B = 2048;
+    std::vector<T> sorted;
+
+    for (size_t i = 0; i < 2 * B - 1; i++)
+        sorted.push_back((T)(std::numeric_limits<T>::min() + i * 256 / (2 * B - 1)));
+
+    auto node = std::make_unique<BTreeNode<T, B>>(sorted.begin(), sorted.end());
+
+    for (size_t n : { sorted.size(), sorted.size() - 17, (size_t)2049 }) {
+        node->n = n;
+        for (int p = std::numeric_limits<T>::min(); p <= std::numeric_limits<T>::max(); p++) {
+            size_t expected =
+                std::lower_bound(sorted.begin(), sorted.begin() + n, (T)p) - sorted.begin();
+            REQUIRE(node->get_index((T)p) == expected);
+        }
+    }
+}
+
+TEST_CASE("get_index on 1-byte keys in wide nodes", "[btree]") {
+    check_wide_byte_node<uint8_t>();
+    check_wide_byte_node<int8_t>();
+    check_wide_byte_node<char>();
+}
+
+TEST_CASE("search finds live keys only", "[btree]") {
+    static constexpr size_t B = 16;
+    BTree<int, B> tree;
+    std::vector<int> xs;
+
+    std::mt19937 g(7);
+
+    for (auto i = 0; i < 20'000; i++)
+        xs.push_back(2 * i);
+
+    std::shuffle(xs.begin(), xs.end(), g);
+
+    for (auto i : xs)
+        tree.insert(i);
+
+    for (auto i = -1; i <= 40'000; i++) {
+        auto [node, idx] = BTreeNode<int, B>::search(tree.root, i);
+        if (i % 2 == 0 && i >= 0 && i < 40'000) {
+            REQUIRE(node != nullptr);
+            REQUIRE(node->keys[idx] == i);
+        } else {
+            REQUIRE(node == nullptr);
+        }
+    }
+
+    /* Removed keys can linger in slots past n; they must not be found */
+    for (auto i = 0; i < 20'000; i += 3)
+        tree.remove(2 * i);
+    for (auto i = 0; i < 20'000; i++)
+        REQUIRE((BTreeNode<int, B>::search(tree.root, 2 * i).first != nullptr) == (i % 3 != 0));
+}
+
+/* Check the B-tree invariants of a subtree: keys in order within the
+   bounds set by the parent, B - 1 to 2B - 1 keys outside the root, and
+   every leaf at the same depth. Returns the number of keys. */
+template<typename T, size_t B>
+static size_t check_subtree(const BTreeNode<T, B>* node, bool is_root, size_t depth,
+                            size_t& leaf_depth, const T* lo, const T* hi) {
+    REQUIRE(node->n <= 2 * B - 1);
+    if (!is_root)
+        REQUIRE(node->n >= B - 1);
+
+    for (size_t i = 0; i < node->n; i++) {
+        if (i > 0) REQUIRE(node->keys[i - 1] < node->keys[i]);
+        if (lo) REQUIRE(*lo < node->keys[i]);
+        if (hi) REQUIRE(node->keys[i] < *hi);
+    }
+
+    if (node->type == NodeType::LEAF) {
+        if (leaf_depth == SIZE_MAX) leaf_depth = depth;
+        REQUIRE(depth == leaf_depth);
+        return node->n;
+    }
+
+    REQUIRE(node->n >= 1);
+
+    size_t count = node->n;
+    for (size_t i = 0; i <= node->n; i++)
+        count += check_subtree(node->edges[i], false, depth + 1, leaf_depth,
+                               i == 0 ? lo : &node->keys[i - 1],
+                               i == node->n ? hi : &node->keys[i]);
+    return count;
+}
+
+template<typename T, size_t B>
+static void check_tree(const BTree<T, B>& tree, size_t n) {
+    if (n == 0) {
+        REQUIRE(tree.root == nullptr);
+        return;
+    }
+
+    size_t leaf_depth = SIZE_MAX;
+    REQUIRE(check_subtree<T, B>(tree.root, true, 0, leaf_depth, nullptr, nullptr) == n);
+    REQUIRE(tree.depth().value() == leaf_depth);
+}
+
+template<typename T, size_t B>
+static size_t tree_size(BTree<T, B>& tree) {
+    size_t n = 0;
+    tree.for_all([&n](T&) { n++; });
+    return n;
+}
+
+TEST_CASE("bulk_load builds a valid tree", "[btree]") {
+    static constexpr size_t B = 4;
+
+    for (size_t n : { 0, 1, 6, 7, 8, 9, 15, 16, 17, 63, 64, 100, 1'000, 12'345 }) {
+        std::vector<int> xs(n);
+        std::iota(xs.begin(), xs.end(), 1);
+
+        for (double fill : { 0.0, 0.5, 0.75, 1.0 }) {
+            for (size_t threads : { 1, 3 }) {
+                BTree<int, B> tree;
+                tree.bulk_load(xs.begin(), xs.end(), fill, threads);
+                check_tree(tree, n);
+
+                std::vector<int> ys;
+                tree.for_all([&ys](int x) { ys.push_back(x); });
+                REQUIRE(ys == xs);
+            }
+        }
+    }
+}
+
+TEST_CASE("bulk_load fill factor and later updates", "[btree]") {
+    static constexpr size_t B = 16;
+    size_t n = 100'000;
+
+    std::vector<int> xs(n);
+    for (size_t i = 0; i < n; i++)
+        xs[i] = 2 * i;
+
+    BTree<int, B> full, half;
+    full.bulk_load(xs.begin(), xs.end(), 1.0, 4);
+    half.bulk_load(xs.begin(), xs.end(), 0.5);
+
+    /* Fraction of all key slots in use */
+    auto utilization = [](BTree<int, B>& tree) {
+        size_t nodes = 0;
+        tree.for_all_nodes([&](const BTreeNode<int, B>&) { nodes++; });
+        return (double)tree_size(tree) / (nodes * (2 * B - 1));
+    };
+
+    REQUIRE(utilization(full) > 0.97);
+    REQUIRE(utilization(half) > 0.45);
+    REQUIRE(utilization(half) < 0.55);
+    REQUIRE(full.depth() <= half.depth());
+
+    /* The result is an ordinary tree: insert the odd keys, then remove
+       every fourth key */
+    std::mt19937 g(11);
+    std::vector<int> odd;
+    for (size_t i = 0; i < n; i++)
+        odd.push_back(2 * i + 1);
+    std::shuffle(odd.begin(), odd.end(), g);
+
+    for (int x : odd)
+        half.insert(x);
+    for (size_t i = 0; i < 2 * n; i += 4)
+        half.remove(i);
+
+    check_tree(half, 2 * n - n / 2);
+    for (size_t i = 0; i < 2 * n; i++)
+        REQUIRE((BTreeNode<int, B>::search(half.root, i).first != nullptr) == (i % 4 != 0));
+
+    /* Loading again replaces the contents */
+    half.bulk_load(xs.begin(), xs.begin() + 10);
+    check_tree(half, 10);
+}
+
+/* Key whose copies draw on a shared budget and throw once it runs out */
+struct BudgetKey {
+    static inline std::atomic<long> budget{ LONG_MAX };
+    int v = 0;
+
+    BudgetKey() = default;
+    BudgetKey(int v) : v(v) {}
+    BudgetKey(const BudgetKey& o) : v(o.v) { spend(); }
+    BudgetKey& operator=(const BudgetKey& o) { spend(); v = o.v; return *this; }
+
+    static void spend() {
+        if (budget.fetch_sub(1) <= 0)
+            throw std::runtime_error("out of copies");
+    }
+
+    bool operator<(const BudgetKey& o) const { return v < o.v; }
+    bool operator==(const BudgetKey& o) const { return v == o.v; }
+};
+
+TEST_CASE("bulk_load cleans up when a key copy throws", "[btree]") {
+    static constexpr size_t B = 3;
+
+    std::vector<BudgetKey> xs;
+    for (int i = 0; i < 3000; i++)
+        xs.emplace_back(i);
+
+    size_t failed = 0, built = 0;
+
+    /* Copies run out in the leaves, in the internal levels, or never */
+    for (long budget = 0; budget < 4000; budget += 7) {
+        for (size_t threads : { 1, 4 }) {
+            BTree<BudgetKey, B> tree;
+            tree.insert(BudgetKey(-1));
+
+            BudgetKey::budget = budget;
+            try {
+                tree.bulk_load(xs.begin(), xs.end(), 1.0, threads);
+                BudgetKey::budget = LONG_MAX;
+                built++;
+                check_tree(tree, xs.size());
+            } catch (const std::runtime_error&) {
+                BudgetKey::budget = LONG_MAX;
+                failed++;
+                REQUIRE(tree.root == nullptr);
+            }
+        }
+    }
+
+    REQUIRE(failed > 0);
+    REQUIRE(built > 0);
+}
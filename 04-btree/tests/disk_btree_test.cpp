@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <string>
+
+#include "disk_btree.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+static std::string temp_path(const char* name) {
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+TEST_CASE("Disk B-tree with a tiny pool", "[disk]") {
+    /* 256-byte pages give B = 15 for int keys; 8 frames force constant
+       eviction */
+    using Tree = DiskBTree<int, 256>;
+    std::string path = temp_path("disk_btree_test_small.db");
+    std::vector<int> xs(20'000);
+
+    std::iota(xs.begin(), xs.end(), 0);
+    std::mt19937 g(3);
+    std::shuffle(xs.begin(), xs.end(), g);
+
+    {
+        Tree tree;
+        REQUIRE(tree.open(path, 8));
+
+        for (auto i = 0; i < 10'000; i++)
+            REQUIRE(tree.insert(2 * xs[i]) == true);
+        REQUIRE(tree.insert(2 * xs[0]) == false);
+        REQUIRE(tree.size() == 10'000);
+        REQUIRE(tree.pool->writes > 0);
+
+        for (auto i = 0; i < 10'000; i++) {
+            REQUIRE(tree.contains(2 * xs[i]) == true);
+            REQUIRE(tree.contains(2 * xs[i] + 1) == false);
+        }
+    }
+
+    /* Everything is back after reopening, and the tree keeps growing */
+    {
+        Tree tree;
+        REQUIRE(tree.open(path, 8));
+        REQUIRE(tree.size() == 10'000);
+
+        for (auto i = 10'000; i < 20'000; i++)
+            REQUIRE(tree.insert(2 * xs[i]) == true);
+        tree.flush();
+
+        std::vector<int> ys;
+        tree.for_all([&](const int& k) { ys.push_back(k); });
+
+        std::vector<int> expected(20'000);
+        for (auto i = 0; i < 20'000; i++)
+            expected[i] = 2 * i;
+        REQUIRE(ys == expected);
+
+        /* Every page below the root holds between B-1 and 2B-1 keys */
+        REQUIRE(tree.depth().has_value());
+        REQUIRE(tree.page_count() * (Tree::B - 1) <= 20'000 + Tree::B);
+    }
+
+    /* A file written for another key size is refused */
+    {
+        DiskBTree<int64_t, 256> other;
+        REQUIRE(other.open(path, 8) == false);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Disk B-tree with 4 KiB pages", "[disk]") {
+    using Tree = DiskBTree<uint64_t>;
+    std::string path = temp_path("disk_btree_test_4k.db");
+
+    REQUIRE(Tree::B == 170);
+
+    std::mt19937_64 g(9);
+    std::vector<uint64_t> xs(100'000);
+    for (auto& x : xs)
+        x = g();
+
+    {
+        Tree tree;
+        REQUIRE(tree.open(path, 16));
+        for (auto x : xs)
+            tree.insert(x);
+        REQUIRE(tree.size() == xs.size());
+        REQUIRE(tree.depth().value() == 2);
+    }
+
+    REQUIRE(std::filesystem::file_size(path) % 4096 == 0);
+
+    Tree tree;
+    REQUIRE(tree.open(path, 16));
+    for (auto i = 0; i < 1000; i++) {
+        REQUIRE(tree.contains(xs[i]) == true);
+        REQUIRE(tree.contains(xs[i] ^ 1) == false);
+    }
+    tree.close();
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Disk B-tree I/O failures", "[disk]") {
+    using Tree = DiskBTree<int, 256>;
+    std::string path = temp_path("disk_btree_test_fail.db");
+
+    /* A page that cannot be pinned is not allocated */
+    {
+        Tree tree;
+        REQUIRE(tree.open(path, 8));
+        for (auto i = 0; i < 1000; i++)
+            tree.insert(i);
+        REQUIRE(tree.page_count() > 9);
+
+        std::vector<Tree::PageRef> pinned;
+        for (uint32_t id = 1; id <= 8; id++)
+            pinned.push_back(tree.fetch(id));
+
+        size_t pages = tree.page_count();
+        REQUIRE_THROWS_AS(tree.allocate(), std::runtime_error);
+        REQUIRE(tree.page_count() == pages);
+    }
+
+    /* Swap the file for a read-only descriptor so every write fails */
+    auto break_writes = [](Tree& tree) {
+        int ro = ::open("/dev/null", O_RDONLY);
+        REQUIRE(ro >= 0);
+        REQUIRE(dup2(ro, tree.fd) == tree.fd);
+        ::close(ro);
+    };
+
+    {
+        Tree tree;
+        REQUIRE(tree.open(path, 8));
+        tree.insert(5000);
+        break_writes(tree);
+
+        REQUIRE_THROWS_AS(tree.close(), std::system_error);
+        REQUIRE(tree.is_open() == false);
+    }
+
+    {
+        // Leaving scope with unwritable pages must not terminate
+        Tree tree;
+        REQUIRE(tree.open(path, 8));
+        tree.insert(5001);
+        break_writes(tree);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Buffer pool survives a failed read during eviction", "[disk]") {
+    std::string path = temp_path("disk_btree_test_pool.db");
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    REQUIRE(fd >= 0);
+
+    /* Pages 0-4 exist, filled with their own id; page 9 is past the end */
+    std::vector<char> page(256);
+    for (int id = 0; id < 5; id++) {
+        std::fill(page.begin(), page.end(), (char)id);
+        REQUIRE(pwrite(fd, page.data(), page.size(), id * 256) == 256);
+    }
+
+    BufferPool<256> pool(fd, 2);
+
+    // Every cached page is mapped to the frame that holds it
+    auto consistent = [&pool] {
+        for (size_t frame = 0; frame < pool.frames.size(); frame++) {
+            uint32_t id = pool.frames[frame].page_id;
+            if (id == 0) continue;
+            auto it = pool.page_table.find(id);
+            if (it == pool.page_table.end() || it->second != frame) return false;
+        }
+        return true;
+    };
+
+    auto touch = [&pool](uint32_t id, char expect, char write) {
+        size_t f = pool.pin(id);
+        REQUIRE(pool.data(f)[0] == expect);
+        pool.data(f)[0] = write;
+        pool.unpin(f, true);
+    };
+
+    for (int round = 0; round < 4; round++) {
+        touch(1, round == 0 ? 1 : 'A' + round - 1, 'A' + round);
+        touch(2, 2, 2);
+
+        REQUIRE_THROWS_AS(pool.pin(9), std::system_error);
+        REQUIRE(consistent());
+
+        // Cycle other pages through so the failed frame is reused
+        for (uint32_t id : { 3, 4, 3, 4 }) {
+            pool.unpin(pool.pin(id), false);
+            REQUIRE(consistent());
+        }
+    }
+
+    touch(1, 'D', 'D');
+    pool.flush_all();
+    REQUIRE(pread(fd, page.data(), 1, 256) == 1);
+    REQUIRE(page[0] == 'D');
+
+    ::close(fd);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <string>
+
+#include "mapped_btree.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+static std::string temp_path(const char* name) {
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+template<size_t B>
+static void check_snapshot(size_t n) {
+    std::string path = temp_path("mapped_btree_test.snap");
+    std::vector<int> xs(n);
+
+    std::iota(xs.begin(), xs.end(), 0);
+    std::transform(xs.begin(), xs.end(), xs.begin(), [](int x) { return 3 * x; });
+
+    {
+        BTree<int, B> tree;
+        std::vector<int> shuffled = xs;
+        std::mt19937 g(B);
+        std::shuffle(shuffled.begin(), shuffled.end(), g);
+        for (auto x : shuffled)
+            tree.insert(x);
+
+        REQUIRE(tree.save_snapshot(path));
+    }
+
+    REQUIRE(std::filesystem::file_size(path) % snapshot_page_size == 0);
+
+    MappedBTree<int> mapped;
+    REQUIRE(mapped.open(path));
+    REQUIRE(mapped.size() == n);
+
+    std::vector<int> ys(mapped.begin(), mapped.end());
+    REQUIRE(ys == xs);
+
+    for (auto i = -1; i <= 3 * (int)n; i++) {
+        const int* k = mapped.find(i);
+        bool present = i >= 0 && i % 3 == 0 && i < 3 * (int)n;
+        REQUIRE((k != nullptr) == present);
+        if (k) REQUIRE(*k == i);
+
+        auto it = mapped.lower_bound(i);
+        auto lb = std::lower_bound(xs.begin(), xs.end(), i);
+        REQUIRE((it == mapped.end()) == (lb == xs.end()));
+        if (lb != xs.end()) REQUIRE(*it == *lb);
+    }
+
+    std::mt19937 g(1);
+    for (auto i = 0; i < 200; i++) {
+        int lo = (int)(g() % (3 * n + 20)) - 10;
+        int hi = lo + (int)(g() % 300);
+
+        std::vector<int> got;
+        mapped.for_each_in_range(lo, hi, [&](int k) { got.push_back(k); });
+        REQUIRE(got == std::vector<int>(std::lower_bound(xs.begin(), xs.end(), lo),
+                                        std::lower_bound(xs.begin(), xs.end(), hi)));
+    }
+
+    mapped.close();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Mapped snapshot answers like the tree it came from", "[snapshot]") {
+    check_snapshot<2>(1);
+    check_snapshot<2>(5'000);
+    check_snapshot<6>(30'000);
+    check_snapshot<64>(30'000);
+}
+
+TEST_CASE("Mapped snapshot edge cases", "[snapshot]") {
+    std::string path = temp_path("mapped_btree_test_edge.snap");
+
+    /* An empty tree gives an empty snapshot */
+    {
+        BTree<int> empty;
+        REQUIRE(empty.save_snapshot(path));
+
+        MappedBTree<int> mapped;
+        REQUIRE(mapped.open(path));
+        REQUIRE(mapped.size() == 0);
+        REQUIRE(mapped.begin() == mapped.end());
+        REQUIRE(mapped.lower_bound(0) == mapped.end());
+        REQUIRE(mapped.find(0) == nullptr);
+    }
+
+    /* Key type is checked, and missing files fail to open */
+    {
+        BTree<int64_t, 4> tree;
+        for (int64_t i = 0; i < 1000; i++)
+            tree.insert(i << 33);
+        REQUIRE(tree.save_snapshot(path));
+
+        MappedBTree<int> wrong;
+        REQUIRE(wrong.open(path) == false);
+
+        MappedBTree<int64_t> right;
+        REQUIRE(right.open(path));
+        REQUIRE(right.contains((int64_t)999 << 33));
+        REQUIRE(!right.contains(999));
+
+        MappedBTree<int64_t> missing;
+        REQUIRE(missing.open(path + ".missing") == false);
+    }
+
+    std::filesystem::remove(path);
+}
+
+static std::vector<char> read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+}
+
+static void write_file(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+template<typename F>
+static void poke(std::vector<char>& bytes, size_t offset, F value) {
+    std::memcpy(&bytes[offset], &value, sizeof value);
+}
+
+TEST_CASE("Mapped snapshot rejects or survives corrupt files", "[snapshot]") {
+    std::string path = temp_path("mapped_btree_test_corrupt.snap");
+
+    BTree<int, 4> tree;
+    for (int i = 0; i < 1000; i++)
+        tree.insert(i);
+    REQUIRE(tree.save_snapshot(path));
+
+    const std::vector<char> good = read_file(path);
+    SnapshotHeader h;
+    std::memcpy(&h, good.data(), sizeof h);
+
+    auto opens = [&](const std::vector<char>& bytes) {
+        write_file(path, bytes);
+        MappedBTree<int> mapped;
+        return mapped.open(path);
+    };
+
+    REQUIRE(opens(good));
+
+    /* Bad record geometry or a short file fails in open() */
+    std::vector<char> bad = good;
+    poke(bad, offsetof(SnapshotHeader, record_size), uint32_t(8));
+    REQUIRE(opens(bad) == false);
+
+    bad = good;
+    poke(bad, offsetof(SnapshotHeader, keys_offset), uint32_t(4));
+    REQUIRE(opens(bad) == false);
+
+    bad = good;
+    poke(bad, offsetof(SnapshotHeader, node_keys), uint32_t(1) << 30);
+    REQUIRE(opens(bad) == false);
+
+    bad = good;
+    poke(bad, offsetof(SnapshotHeader, node_count), uint64_t(1) << 40);
+    REQUIRE(opens(bad) == false);
+
+    bad = good;
+    bad.resize(snapshot_page_size + h.record_size);
+    REQUIRE(opens(bad) == false);
+
+    /* Corrupt records still open, but queries stay inside the mapping:
+       an oversized key count, a child link past the end, and a node
+       that links back to itself */
+    bad = good;
+    auto record = [&](size_t i) { return snapshot_page_size + i * h.record_size; };
+    poke(bad, record(0), UINT32_MAX);
+    poke(bad, record(1) + sizeof(uint32_t), uint32_t(h.node_count - 1));
+    poke(bad, record(2) + sizeof(uint32_t), uint32_t(2));
+    write_file(path, bad);
+
+    MappedBTree<int> mapped;
+    REQUIRE(mapped.open(path));
+
+    for (int i = -10; i < 1010; i++) {
+        const int* k = mapped.find(i);
+        if (k) REQUIRE(*k == i);
+        mapped.lower_bound(i);
+    }
+
+    /* Iteration ends by itself */
+    size_t visited = 0;
+    for (auto it = mapped.begin(); it != mapped.end() && visited < 10'000; ++it)
+        visited++;
+    REQUIRE(visited < 10'000);
+
+    std::filesystem::remove(path);
+}